@@ -0,0 +1,285 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+#include <gmock/gmock.h>
+
+#include <chrono>
+
+#include "Monitor.h"
+#include "FactoriesImplementation.h"
+#include "ServiceMock.h"
+#include "WorkerPoolImplementation.h"
+#include "mocks/MemoryMock.h"
+
+using ::testing::Invoke;
+using ::testing::NiceMock;
+using ::testing::Return;
+
+namespace WPEFramework {
+namespace Plugin {
+
+    // A Monitor watching a number of observables, all activated and reporting a
+    // flat memory curve. The worker pool is never run, so the job the Monitor
+    // submits stays queued and the benchmarks are the only ones calling into it.
+    // The clock is a manual one, a day ahead, so every run finds all observables
+    // due and nothing the Monitor schedules comes up while measuring.
+    class MonitorBenchmark {
+    public:
+        using Observable = Monitor::MonitorObjects::MonitorObject;
+
+        static constexpr uint64_t Second = 1000 * 1000;
+        static constexpr uint64_t MiB = 1024 * 1024;
+
+    public:
+        MonitorBenchmark() = delete;
+        MonitorBenchmark(const MonitorBenchmark&) = delete;
+        MonitorBenchmark& operator=(const MonitorBenchmark&) = delete;
+
+        explicit MonitorBenchmark(const uint32_t count)
+            : _clock(Clock::System().Now() + (24 * 60 * 60 * Second))
+            , _workerPool(Core::ProxyType<WorkerPoolImplementation>::Create(2, Core::Thread::DefaultStackSize(), 16))
+            , _factories()
+            , _service()
+            , _observed()
+            , _memory()
+            , _plugin(Core::ProxyType<Monitor>::Create())
+        {
+            Clock::Assign(&_clock);
+            Core::IWorkerPool::Assign(&(*_workerPool));
+            PluginHost::IFactories::Assign(&_factories);
+
+            ON_CALL(_service, ConfigLine())
+                .WillByDefault(Return(Configuration(count)));
+            ON_CALL(_service, WebPrefix())
+                .WillByDefault(Return(string(_T("/Service/Monitor"))));
+            ON_CALL(_observed, State())
+                .WillByDefault(Return(PluginHost::IShell::ACTIVATED));
+            ON_CALL(_observed, QueryInterface(Exchange::IMemory::ID))
+                .WillByDefault(Return(static_cast<void*>(static_cast<Exchange::IMemory*>(&_memory))));
+            ON_CALL(_memory, Resident())
+                .WillByDefault(Return(64 * MiB));
+            ON_CALL(_memory, IsOperational())
+                .WillByDefault(Return(true));
+
+            _plugin->Initialize(&_service);
+
+            for (uint32_t index = 0; index < count; index++) {
+                _plugin->_monitor.Activated(Callsign(index), &_observed);
+            }
+
+            // The first run picks up the interfaces of every observable.
+            Run();
+        }
+        ~MonitorBenchmark()
+        {
+            _plugin->Deinitialize(&_service);
+
+            PluginHost::IFactories::Assign(nullptr);
+            Core::IWorkerPool::Assign(nullptr);
+            Clock::Assign(nullptr);
+        }
+
+    public:
+        static string Callsign(const uint32_t index)
+        {
+            return (_T("Observed") + std::to_string(index));
+        }
+        // One run of the job, with every observable due.
+        void Run()
+        {
+            _clock.Advance(Second);
+            _plugin->_monitor.Dispatch();
+        }
+        // What the status method hands out, serialized.
+        void Serialize(string& text) const
+        {
+            Core::JSON::ArrayType<Monitor::Info> response;
+
+            _plugin->_monitor.Snapshot(string(), &response);
+            response.ToString(text);
+        }
+        // What the status property hands out for an index, serialized.
+        void Serialize(const string& index, string& text) const
+        {
+            Core::JSON::ArrayType<Monitor::Info> response;
+
+            _plugin->get_status(index, response);
+            response.ToString(text);
+        }
+        Core::ProxyType<Web::Response> Get(const string& path)
+        {
+            Web::Request request;
+
+            request.Verb = Web::Request::HTTP_GET;
+            request.Path = _T("/Service/Monitor") + path;
+
+            return (_plugin->Process(request));
+        }
+
+    public:
+        static void Dispatch(benchmark::State& state)
+        {
+            MonitorBenchmark monitor(static_cast<uint32_t>(state.range(0)));
+
+            for (auto _ : state) {
+                monitor.Run();
+            }
+
+            state.SetItemsProcessed(state.iterations() * state.range(0));
+        }
+        // One evaluation with every IMemory call taking the given MicroSeconds, as an IPC round trip would.
+        static void Evaluate(benchmark::State& state)
+        {
+            const std::chrono::microseconds latency(state.range(0));
+            NiceMock<ServiceMock> shell;
+            NiceMock<MemoryMock> memory;
+
+            const auto call = [latency]() {
+                const auto end = std::chrono::steady_clock::now() + latency;
+                while (std::chrono::steady_clock::now() < end) {
+                }
+            };
+
+            ON_CALL(shell, State())
+                .WillByDefault(Return(PluginHost::IShell::ACTIVATED));
+            ON_CALL(shell, QueryInterface(Exchange::IMemory::ID))
+                .WillByDefault(Return(static_cast<void*>(static_cast<Exchange::IMemory*>(&memory))));
+            ON_CALL(memory, Resident())
+                .WillByDefault(Invoke([call]() { call(); return (64 * MiB); }));
+            ON_CALL(memory, Allocated())
+                .WillByDefault(Invoke([call]() { call(); return (32 * MiB); }));
+            ON_CALL(memory, Shared())
+                .WillByDefault(Invoke([call]() { call(); return (8 * MiB); }));
+            ON_CALL(memory, Processes())
+                .WillByDefault(Invoke([call]() { call(); return (static_cast<uint8_t>(1)); }));
+            ON_CALL(memory, IsOperational())
+                .WillByDefault(Invoke([call]() { call(); return (true); }));
+
+            Observable::Settings settings {};
+            settings.Operational = 1 * Second;
+            settings.Memory = 1 * Second;
+            settings.MemoryMin = settings.Memory;
+            settings.MemoryMax = settings.Memory;
+
+            Observable observable(_T("Observed"), settings, Clock::Now());
+            observable.Attach(&shell);
+            observable.Probe();
+
+            for (auto _ : state) {
+                benchmark::DoNotOptimize(observable.Evaluate(0));
+            }
+
+            observable.Detach();
+        }
+        static void Status(benchmark::State& state)
+        {
+            MonitorBenchmark monitor(static_cast<uint32_t>(state.range(0)));
+            string text;
+
+            for (auto _ : state) {
+                text.clear();
+                monitor.Serialize(text);
+                benchmark::DoNotOptimize(text.data());
+            }
+
+            state.SetItemsProcessed(state.iterations() * state.range(0));
+            state.SetBytesProcessed(state.iterations() * text.length());
+        }
+        // The last resident size of the given number of observables, out of 256.
+        static void StatusProjected(benchmark::State& state)
+        {
+            MonitorBenchmark monitor(256);
+            string index;
+            string text;
+
+            for (uint32_t count = 0; count < static_cast<uint32_t>(state.range(0)); count++) {
+                index += (count != 0 ? _T(",") : _T("")) + Callsign(count);
+            }
+            index += _T("?fields=resident.last");
+
+            for (auto _ : state) {
+                text.clear();
+                monitor.Serialize(index, text);
+                benchmark::DoNotOptimize(text.data());
+            }
+
+            state.SetItemsProcessed(state.iterations() * state.range(0));
+            state.SetBytesProcessed(state.iterations() * text.length());
+        }
+        static void GetAll(benchmark::State& state)
+        {
+            MonitorBenchmark monitor(static_cast<uint32_t>(state.range(0)));
+
+            for (auto _ : state) {
+                benchmark::DoNotOptimize(monitor.Get(string()));
+            }
+
+            state.SetItemsProcessed(state.iterations() * state.range(0));
+        }
+        static void GetOne(benchmark::State& state)
+        {
+            MonitorBenchmark monitor(static_cast<uint32_t>(state.range(0)));
+            const string path(_T("/") + Callsign(0));
+
+            for (auto _ : state) {
+                benchmark::DoNotOptimize(monitor.Get(path));
+            }
+        }
+
+    private:
+        static string Configuration(const uint32_t count)
+        {
+            string result(_T("{\"observables\":["));
+
+            for (uint32_t index = 0; index < count; index++) {
+                if (index != 0) {
+                    result += ',';
+                }
+                result += _T("{\"callsign\":\"") + Callsign(index) + _T("\",\"memory\":1,\"operational\":1,\"memorylimit\":1048576}");
+            }
+
+            result += _T("]}");
+
+            return (result);
+        }
+
+    private:
+        Clock::Manual _clock;
+        Core::ProxyType<WorkerPoolImplementation> _workerPool;
+        FactoriesImplementation _factories;
+        NiceMock<ServiceMock> _service;
+        NiceMock<ServiceMock> _observed;
+        NiceMock<MemoryMock> _memory;
+        Core::ProxyType<Monitor> _plugin;
+    };
+
+} // namespace Plugin
+} // namespace WPEFramework
+
+using WPEFramework::Plugin::MonitorBenchmark;
+
+BENCHMARK(MonitorBenchmark::Dispatch)->RangeMultiplier(4)->Range(1, 256);
+BENCHMARK(MonitorBenchmark::Evaluate)->Arg(0)->Arg(10)->Arg(100);
+BENCHMARK(MonitorBenchmark::Status)->RangeMultiplier(4)->Range(1, 256);
+BENCHMARK(MonitorBenchmark::StatusProjected)->RangeMultiplier(8)->Range(1, 256);
+BENCHMARK(MonitorBenchmark::GetAll)->RangeMultiplier(4)->Range(1, 256);
+BENCHMARK(MonitorBenchmark::GetOne)->RangeMultiplier(4)->Range(1, 256);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,32 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <gmock/gmock.h>
+
+#include "Telemetry.h"
+
+class TelemetrySenderMock : public WPEFramework::Plugin::Telemetry::ISender {
+public:
+    virtual ~TelemetrySenderMock() = default;
+
+    MOCK_METHOD(void, Send, (const std::string& marker, const uint32_t value), (override));
+    MOCK_METHOD(void, Send, (const std::string& marker, const std::string& value), (override));
+};
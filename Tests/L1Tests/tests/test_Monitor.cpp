@@ -0,0 +1,849 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include "Monitor.h"
+#include "ServiceMock.h"
+#include "WorkerPoolImplementation.h"
+#include "mocks/MemoryMock.h"
+#include "mocks/TelemetrySenderMock.h"
+
+using ::testing::Invoke;
+using ::testing::NiceMock;
+using ::testing::Return;
+
+namespace WPEFramework {
+namespace Plugin {
+
+    class MonitorTest : public ::testing::Test {
+    protected:
+        using Observable = Monitor::MonitorObjects::MonitorObject;
+
+        static constexpr uint64_t Second = 1000 * 1000;
+        static constexpr uint64_t MilliSecond = 1000;
+        static constexpr uint64_t MiB = 1024 * 1024;
+        static constexpr uint64_t Start = 1000 * Second;
+
+        MonitorTest()
+            : _clock(Start)
+            , _workerPool(Core::ProxyType<WorkerPoolImplementation>::Create(2, Core::Thread::DefaultStackSize(), 16))
+            , _control()
+            , _service()
+            , _memory()
+            , _plugin(Core::ProxyType<Monitor>::Create())
+            , _curve()
+            , _sample(0)
+        {
+            ON_CALL(_service, QueryInterface(Exchange::IMemory::ID))
+                .WillByDefault(Return(static_cast<void*>(static_cast<Exchange::IMemory*>(&_memory))));
+            ON_CALL(_service, State())
+                .WillByDefault(Return(PluginHost::IShell::ACTIVATED));
+            ON_CALL(_memory, IsOperational())
+                .WillByDefault(Return(true));
+        }
+        ~MonitorTest() override = default;
+
+        // The worker pool is never run, what the Monitor submits to it stays queued,
+        // so the tests are the only ones running the job.
+        void SetUp() override
+        {
+            Monitor::Config config;
+
+            Clock::Assign(&_clock);
+            Core::IWorkerPool::Assign(&(*_workerPool));
+
+            _plugin->_monitor.Open(&_control, config);
+        }
+        void TearDown() override
+        {
+            _plugin->_monitor.Close();
+
+            Core::IWorkerPool::Assign(nullptr);
+            Clock::Assign(nullptr);
+        }
+
+        // Intervals in seconds, limits in KiB, as in the configuration.
+        static Observable::Settings Settings(const uint32_t operational, const uint32_t memory, const uint64_t threshold)
+        {
+            Observable::Settings settings {};
+
+            settings.Operational = operational * Second;
+            settings.Memory = memory * Second;
+            settings.MemoryMin = settings.Memory;
+            settings.MemoryMax = settings.Memory;
+            settings.Threshold = threshold;
+            settings.Grace = Observable::NoGrace;
+
+            return (settings);
+        }
+        // Monitored by the plugin from now on, and activated on the mock shell.
+        Observable& Observe(const Observable::Settings& settings)
+        {
+            Monitor::MonitorObjects& monitor(_plugin->_monitor);
+
+            monitor.Insert(_T("Observed"), settings, Clock::Now());
+            monitor.Activated(_T("Observed"), &_service);
+
+            return (*monitor.Find(_T("Observed")));
+        }
+        // One run of the monitor job, true if it probed; what the probe found in status.
+        bool Dispatch(uint32_t& status)
+        {
+            const size_t before = Records(Recorder::SAMPLE).size();
+
+            _plugin->_monitor.Dispatch();
+
+            const std::vector<Recorder::Record> samples(Records(Recorder::SAMPLE));
+
+            if (samples.size() > before) {
+                status = samples.back().Status;
+            }
+
+            return (samples.size() > before);
+        }
+        // What the flight recorder of the plugin holds of one kind, oldest first.
+        std::vector<Recorder::Record> Records(const Recorder::kind which) const
+        {
+            std::vector<Recorder::Record> records;
+            std::vector<Recorder::Record> result;
+
+            _plugin->_monitor._recorder.Read(records);
+
+            for (const Recorder::Record& record : records) {
+                if (record.Kind == which) {
+                    result.push_back(record);
+                }
+            }
+
+            return (result);
+        }
+        // What restartlimits does to the observable.
+        void RestartLimits(const uint16_t window, const uint8_t limit)
+        {
+            _plugin->_monitor.Update(_T("Observed"), window, limit);
+        }
+        // What setlimits does to the observable, intervals in seconds, limits in KiB.
+        uint32_t Limits(const uint32_t memory, const uint32_t memoryLimit, const uint32_t softLimit, const int32_t operational)
+        {
+            Monitor::LimitsInfo limits;
+            Monitor::LimitsInfo result;
+
+            limits.MetaData = memory;
+            limits.MetaDataLimit = memoryLimit;
+            limits.MetaDataSoftLimit = softLimit;
+            limits.Operational = operational;
+
+            return (_plugin->_monitor.Limits(_T("Observed"), limits, result));
+        }
+        // What the job, a probe thread or the cgroup events do with a violation.
+        void Enforce(Observable& observable, const uint32_t value)
+        {
+            _plugin->_monitor.Enforce(_T("Observed"), observable, value);
+        }
+        // The instance on the mock shell went away, and came back.
+        void Deinitialized()
+        {
+            _plugin->_monitor.Deinitialized(_T("Observed"), &_service);
+        }
+        void Activated()
+        {
+            _plugin->_monitor.Activated(_T("Observed"), &_service);
+        }
+        // What reloadconfig does with a configuration that no longer lists any observable.
+        void Unlisted()
+        {
+            Core::JSON::ArrayType<Monitor::Config::Entry> observables;
+            Monitor::ReloadInfo report;
+
+            _plugin->_monitor.Reload(observables, report);
+        }
+        bool Monitored()
+        {
+            return (_plugin->_monitor.Find(_T("Observed")).IsValid());
+        }
+        const Latency& Enforcement() const
+        {
+            return (_plugin->_monitor._enforcement);
+        }
+        // Resident sizes handed out one per sample, the last one repeats.
+        void Curve(const std::vector<uint64_t>& curve)
+        {
+            _curve = curve;
+            _sample = 0;
+
+            ON_CALL(_memory, Resident())
+                .WillByDefault(Invoke([this]() {
+                    const uint64_t result = _curve[_sample];
+                    if ((_sample + 1) < _curve.size()) {
+                        _sample++;
+                    }
+                    return (result);
+                }));
+        }
+
+    protected:
+        Clock::Manual _clock;
+        Core::ProxyType<WorkerPoolImplementation> _workerPool;
+        NiceMock<ServiceMock> _control; //!< The shell of the Monitor itself.
+        NiceMock<ServiceMock> _service;
+        NiceMock<MemoryMock> _memory;
+        Core::ProxyType<Monitor> _plugin;
+        std::vector<uint64_t> _curve;
+        size_t _sample;
+    };
+
+} // namespace Plugin
+} // namespace WPEFramework
+
+using namespace WPEFramework;
+using namespace WPEFramework::Plugin;
+
+TEST_F(MonitorTest, SlotsStayOnTheGrid)
+{
+    Observable& observable(Observe(Settings(0, 1, 0)));
+    uint32_t status = 0;
+
+    EXPECT_TRUE(Dispatch(status));
+    EXPECT_EQ(Start + (1 * Second), observable.TimeSlot());
+
+    // A late run does not push the following slots back.
+    _clock.Set(Start + (1 * Second) + (300 * MilliSecond));
+    EXPECT_TRUE(Dispatch(status));
+    EXPECT_EQ(Start + (2 * Second), observable.TimeSlot());
+
+    _clock.Set(Start + (1 * Second) + (900 * MilliSecond));
+    EXPECT_FALSE(Dispatch(status));
+
+    // Missed slots are skipped, not caught up on.
+    _clock.Set(Start + (5 * Second) + (500 * MilliSecond));
+    EXPECT_TRUE(Dispatch(status));
+    EXPECT_EQ(Start + (6 * Second), observable.TimeSlot());
+    EXPECT_FALSE(Dispatch(status));
+}
+
+TEST_F(MonitorTest, SlotOnTimeMovesToTheNext)
+{
+    Observable& observable(Observe(Settings(0, 2, 0)));
+    uint32_t status = 0;
+
+    for (uint8_t slot = 0; slot < 5; slot++) {
+        _clock.Set(Start + (slot * 2 * Second));
+        EXPECT_TRUE(Dispatch(status));
+        EXPECT_EQ(Start + ((slot + 1) * 2 * Second), observable.TimeSlot());
+        EXPECT_FALSE(Dispatch(status));
+    }
+}
+
+TEST_F(MonitorTest, OperationalCheckedOnItsOwnInterval)
+{
+    Observe(Settings(2, 1, 0));
+    uint32_t status = 0;
+
+    EXPECT_CALL(_memory, Resident())
+        .Times(4)
+        .WillRepeatedly(Return(10 * MiB));
+    EXPECT_CALL(_memory, IsOperational())
+        .Times(2)
+        .WillRepeatedly(Return(true));
+
+    for (uint8_t slot = 0; slot < 4; slot++) {
+        _clock.Set(Start + (slot * Second));
+        EXPECT_TRUE(Dispatch(status));
+        EXPECT_EQ(static_cast<uint32_t>(Observable::SUCCESFULL), status);
+    }
+}
+
+TEST_F(MonitorTest, HibernatedIsNotProbed)
+{
+    Observe(Settings(0, 1, 0));
+    uint32_t status = 0;
+
+    EXPECT_CALL(_service, State())
+        .WillRepeatedly(Return(PluginHost::IShell::HIBERNATED));
+    EXPECT_CALL(_memory, Resident())
+        .Times(0);
+
+    EXPECT_FALSE(Dispatch(status));
+}
+
+TEST_F(MonitorTest, UnreachableObservableIsNotMeasured)
+{
+    Observable observable(_T("Observed"), Settings(1, 1, 100 * 1024), Start);
+
+    ON_CALL(_service, QueryInterface(Exchange::IMemory::ID))
+        .WillByDefault(Return(nullptr));
+    EXPECT_CALL(_memory, Resident())
+        .Times(0);
+
+    observable.Attach(&_service);
+
+    EXPECT_EQ(static_cast<uint32_t>(Observable::SUCCESFULL), observable.Probe());
+    EXPECT_EQ(0u, observable.Resident());
+}
+
+TEST_F(MonitorTest, NotOperationalIsReported)
+{
+    Observable observable(_T("Observed"), Settings(1, 0, 0), Start);
+
+    EXPECT_CALL(_memory, IsOperational())
+        .WillOnce(Return(true))
+        .WillOnce(Return(false));
+
+    observable.Attach(&_service);
+
+    EXPECT_EQ(static_cast<uint32_t>(Observable::SUCCESFULL), observable.Probe());
+    _clock.Advance(1 * Second);
+    EXPECT_EQ(static_cast<uint32_t>(Observable::NOT_OPERATIONAL), observable.Probe());
+}
+
+TEST_F(MonitorTest, ExceededMemoryOnFirstSampleAboveLimit)
+{
+    Observable& observable(Observe(Settings(0, 1, 100 * 1024)));
+    uint32_t status = 0;
+
+    Curve({ 50 * MiB, 80 * MiB, 120 * MiB });
+
+    EXPECT_TRUE(Dispatch(status));
+    EXPECT_EQ(static_cast<uint32_t>(Observable::SUCCESFULL), status);
+
+    _clock.Advance(1 * Second);
+    EXPECT_TRUE(Dispatch(status));
+    EXPECT_EQ(static_cast<uint32_t>(Observable::SUCCESFULL), status);
+
+    _clock.Advance(1 * Second);
+    EXPECT_TRUE(Dispatch(status));
+    EXPECT_EQ(static_cast<uint32_t>(Observable::EXCEEDED_MEMORY), status);
+    EXPECT_EQ(120 * MiB, observable.Resident());
+}
+
+TEST_F(MonitorTest, SustainDelaysEnforcement)
+{
+    Observable::Settings settings(Settings(0, 1, 100 * 1024));
+    settings.Rule = Violation(1, 1, 2 * Second);
+    Observe(settings);
+    uint32_t status = 0;
+
+    Curve({ 150 * MiB });
+
+    EXPECT_TRUE(Dispatch(status));
+    EXPECT_EQ(static_cast<uint32_t>(Observable::SUCCESFULL), status);
+
+    _clock.Advance(1 * Second);
+    EXPECT_TRUE(Dispatch(status));
+    EXPECT_EQ(static_cast<uint32_t>(Observable::SUCCESFULL), status);
+
+    _clock.Advance(1 * Second);
+    EXPECT_TRUE(Dispatch(status));
+    EXPECT_EQ(static_cast<uint32_t>(Observable::EXCEEDED_MEMORY), status);
+}
+
+TEST_F(MonitorTest, DeactivatedByTheRunThatSawTheViolation)
+{
+    Observable& observable(Observe(Settings(0, 1, 100 * 1024)));
+    uint32_t status = 0;
+    uint8_t sample = 0;
+
+    // Crossed half way between the second and third slot, every call takes 20 ms.
+    ON_CALL(_memory, Resident())
+        .WillByDefault(Invoke([this, &sample]() {
+            _clock.Advance(20 * MilliSecond);
+            return (++sample < 3 ? 50 * MiB : 150 * MiB);
+        }));
+    const uint64_t crossed = Start + (1500 * MilliSecond);
+
+    for (uint8_t slot = 0; slot < 2; slot++) {
+        _clock.Set(Start + (slot * Second));
+        EXPECT_TRUE(Dispatch(status));
+        EXPECT_EQ(static_cast<uint32_t>(Observable::SUCCESFULL), status);
+    }
+    EXPECT_TRUE(Records(Recorder::DEACTIVATE).empty());
+    EXPECT_EQ(0u, Enforcement().Measurements());
+
+    _clock.Set(Start + (2 * Second));
+    EXPECT_TRUE(Dispatch(status));
+    EXPECT_EQ(static_cast<uint32_t>(Observable::EXCEEDED_MEMORY), status);
+
+    // Within one memory interval and the time of the probe from crossing the limit.
+    const std::vector<Recorder::Record> deactivations(Records(Recorder::DEACTIVATE));
+    ASSERT_EQ(1u, deactivations.size());
+    EXPECT_EQ(Start + (2 * Second) + (20 * MilliSecond), deactivations[0].Time);
+    EXPECT_LE(deactivations[0].Time - crossed, (1 * Second) + (20 * MilliSecond));
+    EXPECT_EQ(150 * MiB / 1024, deactivations[0].Value);
+    EXPECT_EQ(1u, Enforcement().Measurements());
+    EXPECT_EQ(150 * MiB, observable.Resident());
+}
+
+TEST_F(MonitorTest, DeactivatedOnceWhenSeenTwice)
+{
+    Observable& observable(Observe(Settings(0, 1, 100 * 1024)));
+    uint32_t status = 0;
+
+    Curve({ 150 * MiB });
+
+    EXPECT_TRUE(Dispatch(status));
+    EXPECT_EQ(static_cast<uint32_t>(Observable::EXCEEDED_MEMORY), status);
+    EXPECT_TRUE(observable.IsClaimed());
+
+    // The cgroup events and a timed out probe, while the deactivation is on its way.
+    Enforce(observable, Observable::EXCEEDED_MEMORY);
+    Enforce(observable, Observable::UNRESPONSIVE | Observable::MEMORY_PRESSURE);
+
+    EXPECT_EQ(1u, Records(Recorder::DEACTIVATE).size());
+    EXPECT_TRUE(Records(Recorder::PRESSURE).empty());
+    EXPECT_EQ(1u, Enforcement().Measurements());
+
+    // Let go of with the instance, the next one is taken down again.
+    Deinitialized();
+    EXPECT_FALSE(observable.IsClaimed());
+
+    Activated();
+    _clock.Advance(1 * Second);
+    EXPECT_TRUE(Dispatch(status));
+    EXPECT_EQ(2u, Records(Recorder::DEACTIVATE).size());
+}
+
+TEST_F(MonitorTest, SoftLimitEscalatesAfterGrace)
+{
+    Observable::Settings settings(Settings(0, 1, 0));
+    settings.SoftThreshold = 80 * 1024;
+    settings.Grace = 3 * Second;
+    Observe(settings);
+    uint32_t status = 0;
+
+    Curve({ 90 * MiB });
+
+    EXPECT_TRUE(Dispatch(status));
+    EXPECT_EQ(static_cast<uint32_t>(Observable::MEMORY_PRESSURE), status);
+
+    for (uint8_t slot = 1; slot < 3; slot++) {
+        _clock.Advance(1 * Second);
+        EXPECT_TRUE(Dispatch(status));
+        EXPECT_EQ(static_cast<uint32_t>(Observable::SUCCESFULL), status);
+    }
+
+    _clock.Advance(1 * Second);
+    EXPECT_TRUE(Dispatch(status));
+    EXPECT_EQ(static_cast<uint32_t>(Observable::EXCEEDED_MEMORY), status);
+}
+
+TEST_F(MonitorTest, GraceOfZeroEscalatesOnTheNextSample)
+{
+    Observable::Settings settings(Settings(0, 1, 0));
+    settings.SoftThreshold = 80 * 1024;
+    settings.Grace = 0;
+    Observe(settings);
+    uint32_t status = 0;
+
+    Curve({ 90 * MiB });
+
+    EXPECT_TRUE(Dispatch(status));
+    EXPECT_EQ(static_cast<uint32_t>(Observable::MEMORY_PRESSURE), status);
+
+    _clock.Advance(1 * Second);
+    EXPECT_TRUE(Dispatch(status));
+    EXPECT_EQ(static_cast<uint32_t>(Observable::EXCEEDED_MEMORY), status);
+}
+
+TEST_F(MonitorTest, NoGraceLeavesTheKillToTheLimit)
+{
+    Observable::Settings settings(Settings(0, 1, 0));
+    settings.SoftThreshold = 80 * 1024;
+    Observe(settings);
+    uint32_t status = 0;
+
+    Curve({ 90 * MiB });
+
+    EXPECT_TRUE(Dispatch(status));
+    EXPECT_EQ(static_cast<uint32_t>(Observable::MEMORY_PRESSURE), status);
+
+    for (uint8_t slot = 1; slot < 10; slot++) {
+        _clock.Advance(1 * Second);
+        EXPECT_TRUE(Dispatch(status));
+        EXPECT_EQ(static_cast<uint32_t>(Observable::SUCCESFULL), status);
+    }
+}
+
+TEST_F(MonitorTest, PressureReportedAgainstMemoryHigh)
+{
+    Observable::Settings settings(Settings(0, 1, 100 * 1024));
+    Observable& observable(Observe(settings));
+
+    // A tenth below the limit without a soft limit, as memory.high of a confined observable.
+    EXPECT_EQ(90 * MiB, observable.PressureThreshold());
+
+    Enforce(observable, Observable::MEMORY_PRESSURE);
+    const std::vector<Recorder::Record> pressure(Records(Recorder::PRESSURE));
+    ASSERT_EQ(1u, pressure.size());
+    EXPECT_EQ(90 * MiB / 1024, pressure[0].Limit);
+
+    settings.SoftThreshold = 80 * 1024;
+    Observable soft(_T("Soft"), settings, Start);
+    EXPECT_EQ(80 * MiB, soft.PressureThreshold());
+}
+
+TEST_F(MonitorTest, EvaluateLatencyCoversSlowObservable)
+{
+    Observable observable(_T("Observed"), Settings(0, 1, 0), Start);
+
+    EXPECT_CALL(_memory, Resident())
+        .WillRepeatedly(Invoke([this]() {
+            _clock.Advance(5 * MilliSecond);
+            return (10 * MiB);
+        }));
+
+    observable.Attach(&_service);
+    observable.Probe();
+
+    EXPECT_EQ(1u, observable.EvaluateLatency().Measurements());
+    EXPECT_EQ(5 * MilliSecond, observable.EvaluateLatency().Max());
+}
+
+TEST_F(MonitorTest, ArrivalMeasuredFromActivation)
+{
+    Observable observable(_T("Observed"), Settings(0, 1, 0), Start);
+
+    observable.Attach(&_service);
+    _clock.Advance(250 * MilliSecond);
+    observable.Probe();
+
+    EXPECT_EQ(250 * MilliSecond, observable.Arrival());
+    EXPECT_EQ(0u, observable.Arrival());
+}
+
+TEST_F(MonitorTest, ShellKeptForEnforcement)
+{
+    Observable observable(_T("Observed"), Settings(0, 1, 0), Start);
+
+    EXPECT_EQ(nullptr, observable.Shell());
+
+    observable.Attach(&_service);
+
+    PluginHost::IShell* shell = observable.Shell();
+    EXPECT_EQ(static_cast<PluginHost::IShell*>(&_service), shell);
+    shell->Release();
+
+    observable.Detach();
+    EXPECT_EQ(nullptr, observable.Shell());
+}
+
+TEST_F(MonitorTest, AcquireForAnInstanceThatIsGoneIsDropped)
+{
+    Observable observable(_T("Observed"), Settings(0, 1, 0), Start);
+
+    EXPECT_CALL(_service, QueryInterface(Exchange::IMemory::ID))
+        .WillOnce(Invoke([this, &observable](const uint32_t) {
+            // Deactivated and activated again, with the same shell, while the first probe asks for it.
+            observable.Attach(&_service);
+            return (static_cast<void*>(static_cast<Exchange::IMemory*>(&_memory)));
+        }))
+        .WillRepeatedly(Return(static_cast<void*>(static_cast<Exchange::IMemory*>(&_memory))));
+    EXPECT_CALL(_service, QueryInterface(Exchange::IStateControl::ID))
+        .WillRepeatedly(Return(nullptr));
+
+    Curve({ 50 * MiB });
+
+    observable.Attach(&_service);
+
+    EXPECT_EQ(static_cast<uint32_t>(Observable::SUCCESFULL), observable.Probe());
+    EXPECT_EQ(0u, observable.Resident());
+
+    _clock.Advance(1 * Second);
+    EXPECT_EQ(static_cast<uint32_t>(Observable::SUCCESFULL), observable.Probe());
+    EXPECT_EQ(50 * MiB, observable.Resident());
+}
+
+TEST_F(MonitorTest, HungProbeOfAPreviousInstanceIsDropped)
+{
+    Observable observable(_T("Observed"), Settings(0, 1, 100 * 1024), Start);
+    uint32_t hung = 0;
+    uint32_t ticket = 0;
+
+    Curve({ 150 * MiB, 50 * MiB });
+
+    observable.Attach(&_service);
+
+    ASSERT_TRUE(observable.ProbeStart(Start, hung));
+    EXPECT_TRUE(observable.ProbeAbandon(Start));
+
+    // Still hung, the next slot is skipped.
+    EXPECT_FALSE(observable.ProbeStart(Start + Second, ticket));
+
+    // Restarted, the new instance is probed while the call into the previous one did not return yet.
+    observable.Attach(&_service);
+    ASSERT_TRUE(observable.ProbeStart(Start + Second, ticket));
+    EXPECT_NE(hung, ticket);
+
+    // When it does return, what it read is dropped and the probe of the new instance goes on.
+    EXPECT_EQ(static_cast<uint32_t>(Observable::SUCCESFULL), observable.Probe(hung));
+    EXPECT_EQ(0u, observable.Resident());
+    EXPECT_FALSE(observable.ProbeEnd(hung));
+    EXPECT_EQ(Start + Second, observable.ProbeStarted());
+
+    _clock.Advance(1 * Second);
+    EXPECT_EQ(static_cast<uint32_t>(Observable::SUCCESFULL), observable.Probe(ticket));
+    EXPECT_EQ(50 * MiB, observable.Resident());
+    EXPECT_TRUE(observable.ProbeEnd(ticket));
+    EXPECT_EQ(0u, observable.ProbeStarted());
+}
+
+TEST_F(MonitorTest, RetiredErasedOnceNoProbeIsInFlight)
+{
+    Observable& observable(Observe(Settings(0, 1, 0)));
+    uint32_t status = 0;
+    uint32_t ticket = 0;
+
+    ASSERT_TRUE(observable.ProbeStart(Start, ticket));
+
+    Unlisted();
+    EXPECT_TRUE(observable.IsRetired());
+
+    // Still in flight, the probe finds it when it returns.
+    EXPECT_FALSE(Dispatch(status));
+    EXPECT_TRUE(Monitored());
+
+    EXPECT_TRUE(observable.ProbeEnd(ticket));
+    _clock.Advance(1 * Second);
+    EXPECT_FALSE(Dispatch(status));
+    EXPECT_FALSE(Monitored());
+}
+
+TEST_F(MonitorTest, RestartsLimitedWithinWindow)
+{
+    Observable::Settings settings(Settings(1, 0, 0));
+    settings.ActOnOperational = true;
+    settings.RestartWindow = 60;
+    settings.RestartLimit = 2;
+    Observable observable(_T("Observed"), settings, Start);
+
+    EXPECT_TRUE(observable.HasRestartAllowed());
+    EXPECT_TRUE(observable.RegisterRestart(PluginHost::IShell::FAILURE));
+    _clock.Advance(10 * Second);
+    EXPECT_TRUE(observable.RegisterRestart(PluginHost::IShell::MEMORY_EXCEEDED));
+    _clock.Advance(10 * Second);
+    EXPECT_FALSE(observable.RegisterRestart(PluginHost::IShell::FAILURE));
+
+    // Given up, a new activation starts counting afresh.
+    _clock.Advance(1 * Second);
+    EXPECT_TRUE(observable.RegisterRestart(PluginHost::IShell::FAILURE));
+}
+
+TEST_F(MonitorTest, RestartLimitsSurviveNewLimits)
+{
+    Observable::Settings settings(Settings(1, 1, 100 * 1024));
+    settings.RestartWindow = 60;
+    settings.RestartLimit = 2;
+    Observable& observable(Observe(settings));
+    uint32_t status = 0;
+
+    RestartLimits(120, 5);
+    EXPECT_EQ(Core::ERROR_NONE, Limits(1, 200 * 1024, 0, 1));
+
+    // The job applies the new limits, the restart limits are the ones set at runtime.
+    EXPECT_TRUE(Dispatch(status));
+    EXPECT_EQ(200 * 1024 * 1024u, observable.MemoryThreshold());
+    EXPECT_EQ(5, observable.RestartLimit());
+    EXPECT_EQ(120, observable.RestartWindow());
+}
+
+TEST_F(MonitorTest, LimitsOutOfRangeAreRejected)
+{
+    Observable& observable(Observe(Settings(1, 1, 100 * 1024)));
+    uint32_t status = 0;
+
+    // Longer than MicroSeconds in 32 bits hold, either way round.
+    EXPECT_EQ(Core::ERROR_BAD_REQUEST, Limits(5000, 100 * 1024, 0, 1));
+    EXPECT_EQ(Core::ERROR_BAD_REQUEST, Limits(1, 100 * 1024, 0, -5000));
+
+    // Pressure has to come before the limit.
+    EXPECT_EQ(Core::ERROR_BAD_REQUEST, Limits(1, 100 * 1024, 100 * 1024, 1));
+    EXPECT_EQ(Core::ERROR_BAD_REQUEST, Limits(1, 100 * 1024, 150 * 1024, 1));
+
+    EXPECT_TRUE(Dispatch(status));
+    EXPECT_EQ(100 * 1024 * 1024u, observable.MemoryThreshold());
+    EXPECT_EQ(0u, observable.MemorySoftThreshold());
+
+    EXPECT_EQ(Core::ERROR_NONE, Limits(4294, 100 * 1024, 80 * 1024, 1));
+    _clock.Advance(1 * Second);
+    EXPECT_TRUE(Dispatch(status));
+    EXPECT_EQ(80 * 1024 * 1024u, observable.MemorySoftThreshold());
+}
+
+TEST_F(MonitorTest, RestartWindowExpires)
+{
+    Observable::Settings settings(Settings(1, 0, 0));
+    settings.ActOnOperational = true;
+    settings.RestartWindow = 60;
+    settings.RestartLimit = 2;
+    Observable observable(_T("Observed"), settings, Start);
+
+    EXPECT_TRUE(observable.RegisterRestart(PluginHost::IShell::FAILURE));
+    _clock.Advance(30 * Second);
+    EXPECT_TRUE(observable.RegisterRestart(PluginHost::IShell::FAILURE));
+
+    // The window opened with the first restart, the third one is past it.
+    _clock.Advance(31 * Second);
+    EXPECT_TRUE(observable.RegisterRestart(PluginHost::IShell::FAILURE));
+    _clock.Advance(1 * Second);
+    EXPECT_TRUE(observable.RegisterRestart(PluginHost::IShell::FAILURE));
+    _clock.Advance(1 * Second);
+    EXPECT_FALSE(observable.RegisterRestart(PluginHost::IShell::FAILURE));
+}
+
+TEST_F(MonitorTest, ProcessesKeptWhileTheyRun)
+{
+    Monitor::MetaData metaData;
+
+    metaData.AddProcesses({ { 100, "WPEFramework", 40 * MiB, 30 * MiB }, { 200, "WPEWebProcess", 200 * MiB, 150 * MiB } });
+    metaData.AddProcesses({ { 100, "WPEFramework", 41 * MiB, 31 * MiB }, { 300, "WPEWebProcess", 20 * MiB, 10 * MiB } });
+
+    // The web process that crashed is gone, its successor starts afresh.
+    ASSERT_EQ(2u, metaData.Children().size());
+    EXPECT_EQ(100u, metaData.Children()[0].Pid);
+    EXPECT_EQ(300u, metaData.Children()[1].Pid);
+    EXPECT_EQ("WPEWebProcess", metaData.Children()[1].Name);
+
+    const Monitor::Data::MetaData status(metaData, true);
+    EXPECT_EQ(2u, status.Processes.Length());
+}
+
+TEST_F(MonitorTest, GraphicsKeptApartFromResident)
+{
+    Monitor::MetaData metaData;
+
+    metaData.AddMeasurements(100 * MiB, 80 * MiB, 20 * MiB, 1);
+    EXPECT_EQ(0u, metaData.Lifetime(Metrics::DMABUF).Measurements());
+
+    metaData.Add(Metrics::DMABUF, 64 * MiB, Start);
+    metaData.Add(Metrics::DMABUF, 32 * MiB, Start);
+
+    const Monitor::Data::MetaData status(metaData, true);
+    EXPECT_EQ(64 * MiB, status.Metric[Metrics::DMABUF].Max.Value());
+    EXPECT_EQ(32 * MiB, status.Metric[Metrics::DMABUF].Last.Value());
+    EXPECT_EQ(1u, status.Count.Value());
+
+    metaData.Reset();
+    EXPECT_EQ(0u, metaData.Lifetime(Metrics::DMABUF).Measurements());
+}
+
+TEST_F(MonitorTest, HistoryOnlyForMetricsThatKeepOne)
+{
+    Monitor::MetaData metaData;
+
+    metaData.AddMeasurements(100 * MiB, 80 * MiB, 20 * MiB, 3);
+
+    for (uint8_t index = 0; index < Metrics::METRICS; index++) {
+        const Metrics::metric which = static_cast<Metrics::metric>(index);
+        const bool history = ((Metrics::Describe(which).Keep & Metrics::HISTORY) != 0);
+
+        EXPECT_EQ(history, metaData.Distribution(which) != nullptr);
+        EXPECT_EQ(history, metaData.Recent(which) != nullptr);
+    }
+
+    EXPECT_EQ(1u, metaData.Distribution(Metrics::RESIDENT)->Measurements());
+    EXPECT_EQ(3u, metaData.Lifetime(Metrics::PROCESS).Last());
+    EXPECT_EQ(0u, metaData.Lifetime(Metrics::DMABUF).Measurements());
+}
+
+TEST_F(MonitorTest, StatusHoldsOnlyTheRequestedFields)
+{
+    Monitor::MetaData metaData;
+    Projection projection;
+
+    metaData.AddMeasurements(100 * MiB, 80 * MiB, 20 * MiB, 1);
+    metaData.AddMeasurements(120 * MiB, 90 * MiB, 30 * MiB, 1);
+
+    ASSERT_TRUE(projection.Fields("resident.last,count"));
+
+    const Monitor::Data::MetaData status(metaData, true, projection);
+    EXPECT_EQ(120 * MiB, status.Metric[Metrics::RESIDENT].Last.Value());
+    EXPECT_EQ(0u, status.Metric[Metrics::RESIDENT].Max.Value());
+    EXPECT_EQ(0u, status.Metric[Metrics::ALLOCATED].Last.Value());
+    EXPECT_EQ(2u, status.Count.Value());
+
+    const Monitor::Data::MetaData full(metaData, true);
+    EXPECT_EQ(120 * MiB, full.Metric[Metrics::RESIDENT].Max.Value());
+    EXPECT_EQ(90 * MiB, full.Metric[Metrics::ALLOCATED].Last.Value());
+}
+
+TEST_F(MonitorTest, StatusCopiesOnlyTheRequestedFields)
+{
+    Monitor::MetaData metaData;
+    Projection projection;
+
+    metaData.AddMeasurements(100 * MiB, 80 * MiB, 20 * MiB, 1);
+    metaData.AddMeasurements(120 * MiB, 90 * MiB, 30 * MiB, 1);
+
+    ASSERT_TRUE(projection.Fields("resident.last,allocated.p95"));
+
+    const Monitor::MetaData copy(metaData, projection);
+    EXPECT_EQ(120 * MiB, copy.Lifetime(Metrics::RESIDENT).Last());
+    EXPECT_EQ(0u, copy.Distribution(Metrics::RESIDENT)->Measurements());
+    EXPECT_EQ(2u, copy.Distribution(Metrics::ALLOCATED)->Measurements());
+    EXPECT_EQ(0u, copy.Recent(Metrics::RESIDENT)->Get(Windows::MINUTE, Clock::Now()).Count);
+
+    const Monitor::Data::MetaData status(copy, true, projection);
+    EXPECT_EQ(120 * MiB, status.Metric[Metrics::RESIDENT].Last.Value());
+    EXPECT_EQ(metaData.Distribution(Metrics::ALLOCATED)->Quantile(0.95), status.Metric[Metrics::ALLOCATED].P95.Value());
+}
+
+TEST_F(MonitorTest, GenerationRisesWithEveryChange)
+{
+    Observable& observable(Observe(Settings(0, 2, 0)));
+    uint32_t status = 0;
+
+    ON_CALL(_memory, Resident())
+        .WillByDefault(Return(10 * MiB));
+
+    const uint64_t initial = observable.Generation();
+
+    EXPECT_TRUE(Dispatch(status));
+    const uint64_t sampled = observable.Generation();
+    EXPECT_GT(sampled, initial);
+    EXPECT_EQ(Observable::Generations().load(), sampled);
+
+    _clock.Set(Start + Second);
+    EXPECT_FALSE(Dispatch(status));
+    EXPECT_EQ(sampled, observable.Generation());
+
+    observable.Reset();
+    EXPECT_GT(observable.Generation(), sampled);
+}
+
+TEST_F(MonitorTest, FailureMarkerSkipsTheBatch)
+{
+    ::testing::StrictMock<TelemetrySenderMock> sender;
+    Telemetry telemetry(sender);
+
+    telemetry.Open(60);
+
+    EXPECT_CALL(sender, Send(std::string("SYST_INFO_JSPPShutdown"), ::testing::Matcher<uint32_t>(1u)))
+        .Times(1);
+
+    telemetry.Event(_T("SYST_INFO_MonitorDeactivate"), _T("Failure"));
+    telemetry.Immediate(_T("SYST_INFO_JSPPShutdown"));
+
+    ::testing::Mock::VerifyAndClearExpectations(&sender);
+
+    EXPECT_CALL(sender, Send(std::string("SYST_INFO_MonitorDeactivate"), ::testing::Matcher<const std::string&>(std::string("Failure:1"))))
+        .Times(1);
+
+    telemetry.Flush();
+}
@@ -0,0 +1,214 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+#include <dirent.h>
+
+#include "CGroup.h"
+
+using namespace WPEFramework::Plugin;
+
+// A directory tree shaped like a cgroup v2 hierarchy, written by hand. The
+// kernel files become plain files, so whatever the code writes can be read back.
+class MonitorCGroup : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        char pattern[] = "/tmp/monitor-cgroup-XXXXXX";
+        ASSERT_NE(nullptr, ::mkdtemp(pattern));
+        _root = pattern;
+        File("cgroup.controllers", "cpu io memory pids\n");
+        File("cgroup.subtree_control", "");
+    }
+    void TearDown() override
+    {
+        Clean(_root);
+    }
+
+    void File(const std::string& name, const std::string& content) const
+    {
+        std::ofstream(_root + '/' + name) << content;
+    }
+    std::string Content(const std::string& name) const
+    {
+        std::ifstream stream(_root + '/' + name);
+        return (std::string(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>()));
+    }
+    // A group as the kernel creates it, with its interface files present.
+    void Populate(const std::string& group) const
+    {
+        for (const char* name : { "cgroup.procs", "memory.high", "memory.max", "memory.current", "memory.stat", "memory.events" }) {
+            File(group + '/' + name, "");
+        }
+    }
+
+private:
+    static void Clean(const std::string& path)
+    {
+        DIR* directory = ::opendir(path.c_str());
+
+        if (directory != nullptr) {
+            struct dirent* entry;
+            while ((entry = ::readdir(directory)) != nullptr) {
+                const std::string name(entry->d_name);
+                if ((name != ".") && (name != "..")) {
+                    const std::string child(path + '/' + name);
+                    if (::unlink(child.c_str()) != 0) {
+                        Clean(child);
+                    }
+                }
+            }
+            ::closedir(directory);
+        }
+        ::rmdir(path.c_str());
+    }
+
+protected:
+    std::string _root;
+};
+
+TEST_F(MonitorCGroup, EnableRequiresMemoryController)
+{
+    EXPECT_TRUE(CGroup::Enable(_root));
+    EXPECT_EQ("+memory", Content("cgroup.subtree_control"));
+
+    File("cgroup.controllers", "cpu io pids\n");
+    EXPECT_FALSE(CGroup::Enable(_root));
+}
+
+TEST_F(MonitorCGroup, CreateAttachAndLimit)
+{
+    CGroup group(_root, "Sample");
+
+    EXPECT_EQ(_root + "/Sample", group.Path());
+    EXPECT_TRUE(group.Create());
+    EXPECT_TRUE(group.Create());
+    Populate("Sample");
+
+    EXPECT_TRUE(group.Attach(1234));
+    EXPECT_EQ("1234", Content("Sample/cgroup.procs"));
+
+    EXPECT_TRUE(group.Limit(90 * 1024, 100 * 1024));
+    EXPECT_EQ("92160", Content("Sample/memory.high"));
+    EXPECT_EQ("102400", Content("Sample/memory.max"));
+
+    EXPECT_TRUE(group.Limit(0, 0));
+    EXPECT_EQ("max", Content("Sample/memory.high"));
+    EXPECT_EQ("max", Content("Sample/memory.max"));
+}
+
+TEST_F(MonitorCGroup, WritesFailWithoutGroup)
+{
+    CGroup group(_root, "Missing");
+
+    EXPECT_FALSE(group.Attach(1234));
+    EXPECT_FALSE(group.Limit(1, 2));
+}
+
+TEST_F(MonitorCGroup, CurrentReadsUsage)
+{
+    CGroup group(_root, "Sample");
+    ASSERT_TRUE(group.Create());
+    Populate("Sample");
+
+    File("Sample/memory.current", "3145728\n");
+    File("Sample/memory.stat", "anon 2097152\nfile 524288\nkernel 4096\nshmem 262144\nfile_mapped 131072\n");
+    File("Sample/cgroup.procs", "1234\n1240\n");
+
+    const CGroup::Usage usage(group.Current());
+    EXPECT_EQ(3145728u, usage.Current);
+    EXPECT_EQ(2097152u, usage.Anonymous);
+    EXPECT_EQ(131072u, usage.Mapped);
+    EXPECT_EQ(2228224u, usage.Resident());
+    EXPECT_EQ(262144u, usage.Shared);
+    EXPECT_EQ(2u, usage.Processes);
+}
+
+TEST_F(MonitorCGroup, ChangedReportsDeltas)
+{
+    CGroup group(_root, "Sample");
+    ASSERT_TRUE(group.Create());
+    Populate("Sample");
+
+    File("Sample/memory.events", "low 0\nhigh 4\nmax 1\noom 0\noom_kill 0\n");
+    CGroup::Events events(group.Changed());
+    EXPECT_EQ(4u, events.High);
+    EXPECT_EQ(1u, events.Max);
+
+    events = group.Changed();
+    EXPECT_EQ(0u, events.High);
+    EXPECT_EQ(0u, events.Max);
+
+    File("Sample/memory.events", "low 0\nhigh 7\nmax 1\noom 1\noom_kill 1\n");
+    events = group.Changed();
+    EXPECT_EQ(3u, events.High);
+    EXPECT_EQ(0u, events.Max);
+    EXPECT_EQ(1u, events.Oom);
+    EXPECT_EQ(1u, events.OomKill);
+
+    const CGroup::Events total(group.Read());
+    EXPECT_EQ(7u, total.High);
+}
+
+TEST_F(MonitorCGroup, RemoveOnlyEmptyGroup)
+{
+    CGroup group(_root, "Sample");
+    ASSERT_TRUE(group.Create());
+    Populate("Sample");
+
+    EXPECT_FALSE(group.Remove());
+}
+
+TEST_F(MonitorCGroup, WatchReportsModifiedEventsFile)
+{
+    CGroup first(_root, "First");
+    CGroup second(_root, "Second");
+    ASSERT_TRUE(first.Create());
+    ASSERT_TRUE(second.Create());
+    Populate("First");
+    Populate("Second");
+
+    CGroupWatch watch;
+    ASSERT_TRUE(watch.IsValid());
+
+    const int one = watch.Add(first.EventsFile());
+    const int two = watch.Add(second.EventsFile());
+    ASSERT_GE(one, 0);
+    ASSERT_GE(two, 0);
+
+    EXPECT_TRUE(watch.Read().empty());
+
+    File("First/memory.events", "high 1\n");
+    File("First/memory.events", "high 2\n");
+    std::vector<int> fired(watch.Read());
+    ASSERT_EQ(1u, fired.size());
+    EXPECT_EQ(one, fired[0]);
+
+    watch.Remove(one);
+    File("First/memory.events", "high 3\n");
+    File("Second/memory.events", "high 1\n");
+    fired = watch.Read();
+    ASSERT_EQ(1u, fired.size());
+    EXPECT_EQ(two, fired[0]);
+}
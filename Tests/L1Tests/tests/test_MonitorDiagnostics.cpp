@@ -0,0 +1,180 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "Diagnostics.h"
+
+using namespace WPEFramework::Plugin;
+
+// A directory tree shaped like /proc, written by hand: a host process 100 with
+// two threads, one of which started process 200.
+class MonitorDiagnostics : public ::testing::Test {
+protected:
+    // Every look at the clock takes a millisecond.
+    class Ticking : public Clock::ISource {
+    public:
+        uint64_t Now() const override
+        {
+            return (_now += 1000);
+        }
+
+    private:
+        mutable std::atomic<uint64_t> _now { 0 };
+    };
+
+    void SetUp() override
+    {
+        char pattern[] = "/tmp/monitor-proc-XXXXXX";
+        ASSERT_NE(nullptr, ::mkdtemp(pattern));
+        _root = pattern;
+
+        File("100/status", "Name:\tWPEProcess\nVmRSS:\t204800 kB\n");
+        File("100/smaps_rollup", "Rss:              204800 kB\nAnonymous:        150000 kB\n");
+        File("100/task/100/comm", "WPEProcess\n");
+        File("100/task/100/wchan", "do_epoll_wait");
+        File("100/task/100/children", "200 ");
+        File("100/task/101/comm", "Worker\n");
+        File("100/task/101/wchan", "0");
+        File("200/status", "Name:\tWebProcess\n");
+        File("200/smaps_rollup", "Rss:              102400 kB\n");
+        File("200/task/200/comm", "WebProcess\n");
+    }
+    void TearDown() override
+    {
+        Clean(_root);
+    }
+
+    void File(const std::string& name, const std::string& content) const
+    {
+        const std::string path(_root + '/' + name);
+
+        for (size_t slash = path.find('/', _root.length() + 1); slash != std::string::npos; slash = path.find('/', slash + 1)) {
+            ::mkdir(path.substr(0, slash).c_str(), 0755);
+        }
+
+        std::ofstream(path) << content;
+    }
+    // Does not compress, so it takes about as much room compressed or not.
+    static std::string Noise(const uint32_t length)
+    {
+        std::string result;
+        uint32_t state = length;
+
+        for (uint32_t index = 0; index < length; index++) {
+            state = (state * 1103515245) + 12345;
+            result += static_cast<char>(state >> 16);
+        }
+
+        return (result);
+    }
+    static std::string Content(const std::string& file)
+    {
+        std::ifstream stream(file);
+        return (std::string(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>()));
+    }
+
+    static void Clean(const std::string& path)
+    {
+        DIR* directory = ::opendir(path.c_str());
+
+        if (directory != nullptr) {
+            struct dirent* entry;
+            while ((entry = ::readdir(directory)) != nullptr) {
+                const std::string name(entry->d_name);
+                if ((name != ".") && (name != "..")) {
+                    const std::string child(path + '/' + name);
+                    if (::unlink(child.c_str()) != 0) {
+                        Clean(child);
+                    }
+                }
+            }
+            ::closedir(directory);
+        }
+        ::rmdir(path.c_str());
+    }
+
+protected:
+    std::string _root;
+};
+
+TEST_F(MonitorDiagnostics, CaptureCoversTheProcessTree)
+{
+    const Diagnostics diagnostics(_root);
+    const std::string text(diagnostics.Capture(100, 1000 * 1000));
+
+    EXPECT_NE(std::string::npos, text.find("=== 100 status\nName:\tWPEProcess\nVmRSS:\t204800 kB\n"));
+    EXPECT_NE(std::string::npos, text.find("=== 100 smaps_rollup\nRss:              204800 kB\n"));
+    EXPECT_NE(std::string::npos, text.find("=== 100 threads\n100 WPEProcess do_epoll_wait\n101 Worker 0\n"));
+    EXPECT_NE(std::string::npos, text.find("=== 200 smaps_rollup\nRss:              102400 kB\n"));
+    EXPECT_NE(std::string::npos, text.find("=== 200 threads\n200 WebProcess -\n"));
+    EXPECT_LT(text.find("=== 100 threads"), text.find("=== 200 status"));
+    EXPECT_EQ(std::string::npos, text.find("truncated"));
+}
+
+TEST_F(MonitorDiagnostics, CaptureStopsAtTheBudget)
+{
+    Ticking clock;
+    const Diagnostics diagnostics(_root);
+
+    Clock::Assign(&clock);
+    const std::string text(diagnostics.Capture(100, 4000));
+    Clock::Assign(nullptr);
+
+    EXPECT_NE(std::string::npos, text.find("=== 100 status"));
+    EXPECT_EQ(std::string::npos, text.find("=== 200"));
+    EXPECT_EQ(text.length() - 14, text.rfind("=== truncated\n"));
+}
+
+TEST_F(MonitorDiagnostics, ArchiveKeepsTheLatestWithinTheLimit)
+{
+    const std::string directory(_root + "/captures");
+    const std::string capture(Noise(100));
+    DiagnosticsArchive archive;
+
+    EXPECT_FALSE(archive.Open(std::string(), 1024));
+    ASSERT_TRUE(archive.Open(directory, 260));
+
+    EXPECT_TRUE(archive.Store(3000, "Cobalt", capture));
+    EXPECT_TRUE(archive.Store(1000, "Netflix", capture));
+    EXPECT_TRUE(archive.Store(2000, "Cobalt", capture));
+
+    std::vector<std::string> captures(archive.Captures());
+    ASSERT_EQ(2u, captures.size());
+    EXPECT_EQ(std::string("00000000000000002000-Cobalt") + DiagnosticsArchive::Extension(), captures[0]);
+    EXPECT_EQ(std::string("00000000000000003000-Cobalt") + DiagnosticsArchive::Extension(), captures[1]);
+
+#ifndef ENABLE_DIAGNOSTICS_COMPRESSION
+    EXPECT_EQ(capture, Content(directory + '/' + captures[1]));
+#endif
+
+    // Too big on its own, it stays but the rest goes.
+    EXPECT_TRUE(archive.Store(4000, "Amazon", Noise(300)));
+
+    captures = archive.Captures();
+    ASSERT_EQ(1u, captures.size());
+    EXPECT_EQ(std::string("00000000000000004000-Amazon") + DiagnosticsArchive::Extension(), captures[0]);
+}
@@ -0,0 +1,175 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "DmaBuf.h"
+
+using namespace WPEFramework::Plugin;
+
+// A directory tree shaped like /proc, written by hand. The open files of the
+// processes are links to files standing in for the buffers, so a buffer opened
+// twice has the same inode, just as on the real thing.
+class MonitorDmaBuf : public ::testing::Test {
+protected:
+    static constexpr uint64_t MiB = 1024 * 1024;
+
+    void SetUp() override
+    {
+        char pattern[] = "/tmp/monitor-proc-XXXXXX";
+        ASSERT_NE(nullptr, ::mkdtemp(pattern));
+        _root = pattern;
+
+        File("dmabuf/surface", "");
+        File("dmabuf/texture", "");
+        File("dmabuf/video", "");
+        File("null", "");
+
+        Open(100, 0, "null", 0);
+        Open(100, 5, "dmabuf/surface", 8 * MiB);
+        Open(200, 5, "dmabuf/surface", 8 * MiB);
+        Open(200, 6, "dmabuf/texture", 4 * MiB);
+    }
+    void TearDown() override
+    {
+        Clean(_root);
+    }
+
+    // The fdinfo of a dma-buf, as the kernel writes it. Buffers with a colon in their name
+    // stand for anonymous ones, their links lead nowhere.
+    void Open(const uint32_t pid, const uint32_t fd, const std::string& buffer, const uint64_t size) const
+    {
+        const std::string path(std::to_string(pid));
+
+        File(path + "/fdinfo/" + std::to_string(fd), "pos:\t0\nflags:\t02000002\nmnt_id:\t9\nino:\t" + std::to_string(Inode(buffer)) + "\nsize:\t" + std::to_string(size) + "\ncount:\t2\nexp_name:\tsystem\n");
+        File(path + "/fd/.keep", "");
+        ::symlink((buffer.find(':') != std::string::npos ? buffer : _root + '/' + buffer).c_str(), (_root + '/' + path + "/fd/" + std::to_string(fd)).c_str());
+    }
+    void Close(const uint32_t pid, const uint32_t fd) const
+    {
+        ::unlink((_root + '/' + std::to_string(pid) + "/fd/" + std::to_string(fd)).c_str());
+        ::unlink((_root + '/' + std::to_string(pid) + "/fdinfo/" + std::to_string(fd)).c_str());
+    }
+    uint64_t Inode(const std::string& buffer) const
+    {
+        struct stat info;
+        return (::stat((_root + '/' + buffer).c_str(), &info) == 0 ? info.st_ino : 0);
+    }
+    void File(const std::string& name, const std::string& content) const
+    {
+        const std::string path(_root + '/' + name);
+
+        for (size_t slash = path.find('/', _root.length() + 1); slash != std::string::npos; slash = path.find('/', slash + 1)) {
+            ::mkdir(path.substr(0, slash).c_str(), 0755);
+        }
+
+        std::ofstream(path) << content;
+    }
+
+    static void Clean(const std::string& path)
+    {
+        DIR* directory = ::opendir(path.c_str());
+
+        if (directory != nullptr) {
+            struct dirent* entry;
+            while ((entry = ::readdir(directory)) != nullptr) {
+                const std::string name(entry->d_name);
+                if ((name != ".") && (name != "..")) {
+                    const std::string child(path + '/' + name);
+                    if (::unlink(child.c_str()) != 0) {
+                        Clean(child);
+                    }
+                }
+            }
+            ::closedir(directory);
+        }
+        ::rmdir(path.c_str());
+    }
+
+protected:
+    std::string _root;
+};
+
+TEST_F(MonitorDmaBuf, SharedBuffersCountOnce)
+{
+    DmaBuf dmabuf(_root, _root + "/bufinfo");
+
+    EXPECT_EQ(12 * MiB, dmabuf.Measure({ 100, 200 }));
+    EXPECT_EQ(2u, dmabuf.Cached());
+    EXPECT_EQ(2u, dmabuf.Reads());
+
+    EXPECT_EQ(8 * MiB, dmabuf.Measure({ 100 }));
+    EXPECT_EQ(0u, dmabuf.Measure({ 300 }));
+}
+
+TEST_F(MonitorDmaBuf, RescanOnlyReadsNewBuffers)
+{
+    DmaBuf dmabuf(_root, _root + "/bufinfo");
+
+    EXPECT_EQ(12 * MiB, dmabuf.Measure({ 100, 200 }));
+    EXPECT_EQ(12 * MiB, dmabuf.Measure({ 100, 200 }));
+    EXPECT_EQ(0u, dmabuf.Reads());
+
+    Open(200, 7, "dmabuf/video", 16 * MiB);
+
+    EXPECT_EQ(28 * MiB, dmabuf.Measure({ 100, 200 }));
+    EXPECT_EQ(1u, dmabuf.Reads());
+    EXPECT_EQ(3u, dmabuf.Cached());
+
+    Close(200, 6);
+
+    EXPECT_EQ(24 * MiB, dmabuf.Measure({ 100, 200 }));
+    EXPECT_EQ(0u, dmabuf.Reads());
+    EXPECT_EQ(2u, dmabuf.Cached());
+}
+
+TEST_F(MonitorDmaBuf, DebugListingTakesPrecedence)
+{
+    DmaBuf dmabuf(_root, _root + "/bufinfo");
+
+    File("bufinfo", "\nDma-buf Objects:\nsize    \tflags   \tmode    \tcount   \texp_name\tino     \tname\n"
+        "00004096\t0000000a\t00080007\t00000003\tsystem\t" + std::to_string(Inode("dmabuf/surface")) + "\tsurface\n"
+        "\tAttached Devices:\nTotal 0 devices attached\n\n"
+        "\nTotal 1 objects, 4096 bytes\n");
+
+    EXPECT_EQ(4096 + (4 * MiB), dmabuf.Measure({ 100, 200 }));
+    // The listing, and the fdinfo of the one buffer it did not have.
+    EXPECT_EQ(2u, dmabuf.Reads());
+}
+
+TEST_F(MonitorDmaBuf, AnonymousBuffersAreReadEveryTime)
+{
+    DmaBuf dmabuf(_root, _root + "/bufinfo");
+
+    Open(300, 4, "anon_inode:dmabuf", 2 * MiB);
+    Open(300, 9, "anon_inode:dmabuf", 1 * MiB);
+
+    EXPECT_EQ(3 * MiB, dmabuf.Measure({ 300 }));
+    EXPECT_EQ(3 * MiB, dmabuf.Measure({ 300 }));
+    EXPECT_EQ(2u, dmabuf.Reads());
+    EXPECT_EQ(0u, dmabuf.Cached());
+}
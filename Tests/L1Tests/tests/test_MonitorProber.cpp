@@ -0,0 +1,207 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <memory>
+#include <mutex>
+
+#include "Prober.h"
+
+using namespace WPEFramework::Plugin;
+
+namespace {
+
+// Counted down by the prober threads, waited for by the test.
+class Latch {
+public:
+    Latch(const Latch&) = delete;
+    Latch& operator=(const Latch&) = delete;
+
+    explicit Latch(const uint32_t count)
+        : _lock()
+        , _signal()
+        , _count(count)
+    {
+    }
+
+    void CountDown()
+    {
+        std::unique_lock<std::mutex> guard(_lock);
+        if (_count != 0) {
+            _count--;
+        }
+        _signal.notify_all();
+    }
+    // The timeout only keeps a broken pool from hanging the test, it is not waited out otherwise.
+    bool Wait()
+    {
+        std::unique_lock<std::mutex> guard(_lock);
+        return (_signal.wait_for(guard, std::chrono::seconds(5), [this]() { return (_count == 0); }));
+    }
+
+private:
+    std::mutex _lock;
+    std::condition_variable _signal;
+    uint32_t _count;
+};
+
+// Lets a task go once it is destructed, with the queue it sits in.
+class Release {
+public:
+    Release(const Release&) = delete;
+    Release& operator=(const Release&) = delete;
+
+    explicit Release(std::promise<void>& release)
+        : _release(release)
+    {
+    }
+    ~Release()
+    {
+        _release.set_value();
+    }
+
+private:
+    std::promise<void>& _release;
+};
+
+}
+
+TEST(MonitorProber, RunsWhatIsSubmitted)
+{
+    Prober prober;
+    Latch done(10);
+    std::atomic<uint32_t> runs(0);
+
+    EXPECT_FALSE(prober.Submit([&runs]() { runs++; return (false); }));
+
+    ASSERT_TRUE(prober.Open(2, 0));
+    EXPECT_FALSE(prober.Open(2, 0));
+
+    for (uint8_t index = 0; index < 10; index++) {
+        EXPECT_TRUE(prober.Submit([&runs, &done]() { runs++; done.CountDown(); return (false); }));
+    }
+
+    EXPECT_TRUE(done.Wait());
+    EXPECT_EQ(10u, runs.load());
+
+    EXPECT_EQ(0u, prober.Close());
+    EXPECT_EQ(0u, prober.Threads());
+    EXPECT_FALSE(prober.Submit([&runs]() { runs++; return (false); }));
+}
+
+TEST(MonitorProber, AbandonedTaskDoesNotHoldUpTheOthers)
+{
+    Prober prober;
+    std::promise<void> release;
+    std::shared_future<void> released(release.get_future());
+    Latch started(1);
+    Latch done(1);
+    std::atomic<uint32_t> runs(0);
+
+    ASSERT_TRUE(prober.Open(1, 1));
+
+    // Given up on, as the monitor reports it when the probe returns.
+    EXPECT_TRUE(prober.Submit([released, &started]() { started.CountDown(); released.wait(); return (true); }));
+    EXPECT_TRUE(started.Wait());
+    EXPECT_EQ(1u, prober.Running());
+
+    EXPECT_TRUE(prober.Submit([&runs, &done]() { runs++; done.CountDown(); return (false); }));
+    EXPECT_EQ(1u, prober.Threads());
+
+    prober.Abandon();
+    EXPECT_EQ(2u, prober.Threads());
+    EXPECT_TRUE(done.Wait());
+    EXPECT_EQ(1u, runs.load());
+
+    release.set_value();
+    prober.Close();
+    EXPECT_EQ(0u, prober.Threads());
+}
+
+TEST(MonitorProber, SpareThreadsAreBounded)
+{
+    Prober prober;
+    std::promise<void> release;
+    std::shared_future<void> released(release.get_future());
+    Latch first(1);
+    Latch second(1);
+    Latch done(1);
+    std::atomic<uint32_t> runs(0);
+
+    ASSERT_TRUE(prober.Open(1, 1));
+
+    EXPECT_TRUE(prober.Submit([released, &first]() { first.CountDown(); released.wait(); return (true); }));
+    EXPECT_TRUE(first.Wait());
+    prober.Abandon();
+    EXPECT_EQ(2u, prober.Threads());
+
+    EXPECT_TRUE(prober.Submit([released, &second]() { second.CountDown(); released.wait(); return (true); }));
+    EXPECT_TRUE(second.Wait());
+    prober.Abandon();
+
+    // No spare thread left, what comes in waits for one of the two to return.
+    EXPECT_EQ(2u, prober.Threads());
+    EXPECT_EQ(2u, prober.Running());
+    EXPECT_TRUE(prober.Submit([&runs, &done]() { runs++; done.CountDown(); return (false); }));
+
+    release.set_value();
+    EXPECT_TRUE(done.Wait());
+    EXPECT_EQ(1u, runs.load());
+
+    prober.Close();
+    EXPECT_EQ(0u, prober.Threads());
+}
+
+TEST(MonitorProber, CloseWaitsForWhatRuns)
+{
+    Prober prober;
+    std::promise<void> release;
+    std::shared_future<void> released(release.get_future());
+    Latch started(1);
+    std::atomic<bool> finished(false);
+    std::atomic<uint32_t> runs(0);
+
+    ASSERT_TRUE(prober.Open(1, 0));
+
+    EXPECT_TRUE(prober.Submit([released, &started, &finished]() { started.CountDown(); released.wait(); finished = true; return (false); }));
+    EXPECT_TRUE(started.Wait());
+
+    // Queued behind the running one and dropped by the Close, which is what lets that one return.
+    std::shared_ptr<Release> owned(std::make_shared<Release>(release));
+    EXPECT_TRUE(prober.Submit([owned, &runs]() { runs++; return (false); }));
+    EXPECT_EQ(2, owned.use_count());
+    owned.reset();
+
+    EXPECT_EQ(1u, prober.Close());
+    EXPECT_TRUE(finished.load());
+    EXPECT_EQ(0u, runs.load());
+    EXPECT_EQ(0u, prober.Threads());
+
+    // Opens again with fresh threads.
+    Latch done(1);
+    ASSERT_TRUE(prober.Open(1, 0));
+    EXPECT_TRUE(prober.Submit([&runs, &done]() { runs++; done.CountDown(); return (false); }));
+    EXPECT_TRUE(done.Wait());
+    EXPECT_EQ(1u, runs.load());
+}
@@ -0,0 +1,163 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "Processes.h"
+
+using namespace WPEFramework::Plugin;
+
+// A directory tree shaped like /proc, written by hand: a browser host 100 that
+// started a web process 200 and a network process 300, the web process started
+// another web process 400.
+class MonitorProcesses : public ::testing::Test {
+protected:
+    static constexpr uint64_t Second = 1000 * 1000;
+
+    void SetUp() override
+    {
+        char pattern[] = "/tmp/monitor-proc-XXXXXX";
+        ASSERT_NE(nullptr, ::mkdtemp(pattern));
+        _root = pattern;
+
+        Process(100, "WPEFramework", 40960, 30720);
+        File("100/task/100/children", "200 ");
+        File("100/task/101/children", "300 ");
+        Process(200, "WPEWebProcess", 204800, 153600);
+        File("200/task/200/children", "400 ");
+        Process(300, "WPENetworkProcess", 20480, 10240);
+        Process(400, "WPEWebProcess", 102400, 81920);
+    }
+    void TearDown() override
+    {
+        Clean(_root);
+    }
+
+    // Sizes in KiB, as /proc has them.
+    void Process(const uint32_t pid, const std::string& name, const uint64_t resident, const uint64_t proportional) const
+    {
+        const std::string path(std::to_string(pid));
+
+        File(path + "/status", "Name:\t" + name + "\nState:\tS (sleeping)\nVmRSS:\t    " + std::to_string(resident) + " kB\nThreads:\t1\n");
+        File(path + "/smaps_rollup", "00400000-7fff0000 ---p 00000000 00:00 0    [rollup]\nRss:     " + std::to_string(resident) + " kB\nPss:     " + std::to_string(proportional) + " kB\n");
+        File(path + "/task/" + path + "/comm", name + '\n');
+    }
+    void File(const std::string& name, const std::string& content) const
+    {
+        const std::string path(_root + '/' + name);
+
+        for (size_t slash = path.find('/', _root.length() + 1); slash != std::string::npos; slash = path.find('/', slash + 1)) {
+            ::mkdir(path.substr(0, slash).c_str(), 0755);
+        }
+
+        std::ofstream(path) << content;
+    }
+
+    static void Clean(const std::string& path)
+    {
+        DIR* directory = ::opendir(path.c_str());
+
+        if (directory != nullptr) {
+            struct dirent* entry;
+            while ((entry = ::readdir(directory)) != nullptr) {
+                const std::string name(entry->d_name);
+                if ((name != ".") && (name != "..")) {
+                    const std::string child(path + '/' + name);
+                    if (::unlink(child.c_str()) != 0) {
+                        Clean(child);
+                    }
+                }
+            }
+            ::closedir(directory);
+        }
+        ::rmdir(path.c_str());
+    }
+
+protected:
+    std::string _root;
+};
+
+TEST_F(MonitorProcesses, WalkFindsTheWholeTree)
+{
+    const ProcessTree tree(_root);
+    const std::vector<ProcessTree::Process> processes(tree.Walk(100));
+
+    ASSERT_EQ(4u, processes.size());
+
+    EXPECT_EQ(100u, processes[0].Pid);
+    EXPECT_EQ("WPEFramework", processes[0].Name);
+    EXPECT_EQ(40960u * 1024, processes[0].Resident);
+    EXPECT_EQ(30720u * 1024, processes[0].Proportional);
+
+    EXPECT_EQ(400u, processes[3].Pid);
+    EXPECT_EQ("WPEWebProcess", processes[3].Name);
+    EXPECT_EQ(102400u * 1024, processes[3].Resident);
+    EXPECT_EQ(81920u * 1024, processes[3].Proportional);
+
+    const std::vector<uint32_t> pids(tree.Pids(100));
+
+    ASSERT_EQ(4u, pids.size());
+    EXPECT_EQ(100u, pids.front());
+    EXPECT_EQ(400u, pids.back());
+
+    EXPECT_EQ("WPENetworkProcess", tree.Name(300));
+    EXPECT_EQ("", tree.Name(500));
+}
+
+TEST_F(MonitorProcesses, WalkSkipsWhatIsGone)
+{
+    File("100/task/101/children", "300 500 ");
+
+    const std::vector<ProcessTree::Process> processes(ProcessTree(_root).Walk(100));
+
+    EXPECT_EQ(4u, processes.size());
+    EXPECT_TRUE(ProcessTree(_root).Walk(500).empty());
+}
+
+TEST_F(MonitorProcesses, OnlyTheProcessesOverTheirLimitAreBlamed)
+{
+    const std::vector<ProcessTree::Process> processes(ProcessTree(_root).Walk(100));
+    ProcessRoles roles;
+
+    roles.Configure({ { "WPEWebProcess", 150 * 1024, true }, { "WPENetworkProcess", 10 * 1024, false }, { "WPEFramework", 0, false } }, Violation(2, 2, 0));
+
+    // Two samples in a row before the filter lets it through.
+    EXPECT_TRUE(roles.Check(processes, 0).empty());
+
+    const std::vector<ProcessRoles::Culprit> culprits(roles.Check(processes, 1 * Second));
+
+    ASSERT_EQ(2u, culprits.size());
+    EXPECT_EQ(200u, culprits[0].Pid);
+    EXPECT_EQ("WPEWebProcess", culprits[0].Role);
+    EXPECT_EQ(204800u, culprits[0].Resident);
+    EXPECT_EQ(150u * 1024, culprits[0].Limit);
+    EXPECT_TRUE(culprits[0].Narrow);
+    EXPECT_EQ(300u, culprits[1].Pid);
+    EXPECT_FALSE(culprits[1].Narrow);
+
+    roles.Reset();
+    EXPECT_TRUE(roles.Check(processes, 2 * Second).empty());
+}
@@ -0,0 +1,120 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "Projection.h"
+
+using WPEFramework::Plugin::Metrics;
+using WPEFramework::Plugin::Projection;
+
+TEST(MonitorProjection, EverythingUnlessAskedOtherwise)
+{
+    Projection projection;
+
+    EXPECT_TRUE(projection.Fields(""));
+
+    for (uint8_t index = 0; index < Metrics::METRICS; index++) {
+        EXPECT_EQ(Projection::STATISTICS, projection.Statistics(static_cast<Metrics::metric>(index)));
+    }
+    EXPECT_TRUE(projection.Has(Projection::OPERATIONAL));
+    EXPECT_TRUE(projection.Has(Projection::COUNT));
+    EXPECT_TRUE(projection.Has(Projection::PROCESSES));
+    EXPECT_TRUE(projection.Has(Projection::RESTART));
+}
+
+TEST(MonitorProjection, OnlyTheNamedFields)
+{
+    Projection projection;
+
+    ASSERT_TRUE(projection.Fields("resident.last,resident.p95,dmabuf,operational"));
+
+    EXPECT_EQ(Projection::LAST | Projection::P95, projection.Statistics(Metrics::RESIDENT));
+    EXPECT_EQ(Projection::STATISTICS, projection.Statistics(Metrics::DMABUF));
+    EXPECT_EQ(0u, projection.Statistics(Metrics::ALLOCATED));
+    EXPECT_EQ(0u, projection.Statistics(Metrics::PROCESS));
+    EXPECT_TRUE(projection.Has(Projection::OPERATIONAL));
+    EXPECT_FALSE(projection.Has(Projection::COUNT));
+    EXPECT_FALSE(projection.Has(Projection::RESTART));
+}
+
+TEST(MonitorProjection, UnknownFieldChangesNothing)
+{
+    Projection projection;
+
+    EXPECT_FALSE(projection.Fields("resident.last,resident.median"));
+    EXPECT_FALSE(projection.Fields("operational.last"));
+    EXPECT_FALSE(projection.Fields("observable"));
+
+    EXPECT_EQ(Projection::STATISTICS, projection.Statistics(Metrics::ALLOCATED));
+    EXPECT_TRUE(projection.Has(Projection::COUNT));
+}
+
+TEST(MonitorProjection, RequestNamesCallsignsAndFields)
+{
+    std::vector<std::string> callsigns;
+    Projection projection;
+
+    ASSERT_TRUE(Projection::Parse("Cobalt,,Netflix,?fields=resident.last", callsigns, projection));
+    ASSERT_EQ(2u, callsigns.size());
+    EXPECT_EQ("Cobalt", callsigns[0]);
+    EXPECT_EQ("Netflix", callsigns[1]);
+    EXPECT_EQ(Projection::LAST, projection.Statistics(Metrics::RESIDENT));
+
+    ASSERT_TRUE(Projection::Parse("", callsigns, projection));
+    EXPECT_TRUE(callsigns.empty());
+
+    EXPECT_FALSE(Projection::Parse("Cobalt?fields=size", callsigns, projection));
+
+    EXPECT_EQ("count", Projection::Parameter("since=12&fields=count", "fields"));
+    EXPECT_EQ("", Projection::Parameter("fieldset=count", "fields"));
+}
+
+TEST(MonitorProjection, SinceTakenFromTheQuery)
+{
+    std::vector<std::string> callsigns;
+    Projection projection;
+
+    EXPECT_EQ(0u, projection.Since());
+
+    ASSERT_TRUE(Projection::Parse("Cobalt?since=1718000000000042&fields=count", callsigns, projection));
+    EXPECT_EQ(1718000000000042u, projection.Since());
+    EXPECT_TRUE(projection.Has(Projection::COUNT));
+    EXPECT_FALSE(projection.Has(Projection::OPERATIONAL));
+
+    Projection everything;
+    ASSERT_TRUE(everything.Query("since=7"));
+    EXPECT_EQ(7u, everything.Since());
+    EXPECT_EQ(Projection::STATISTICS, everything.Statistics(Metrics::RESIDENT));
+}
+
+TEST(MonitorProjection, FieldsNamedAfterTheMetrics)
+{
+    for (uint8_t index = 0; index < Metrics::METRICS; index++) {
+        const Metrics::metric which = static_cast<Metrics::metric>(index);
+        Projection projection;
+
+        EXPECT_EQ(which, Metrics::Find(Metrics::Describe(which).Name));
+        ASSERT_TRUE(projection.Fields(std::string(Metrics::Describe(which).Name) + ".last"));
+        EXPECT_EQ(Projection::LAST, projection.Statistics(which));
+    }
+
+    EXPECT_EQ(Metrics::METRICS, Metrics::Find("graphics"));
+    EXPECT_EQ(Metrics::METRICS, Metrics::Find("resident.last"));
+}
@@ -0,0 +1,150 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+#include "Recorder.h"
+
+using WPEFramework::Plugin::Clock;
+using WPEFramework::Plugin::Recorder;
+
+TEST(MonitorRecorder, NothingRecordedBeforeOpen)
+{
+    Recorder recorder;
+    std::vector<Recorder::Record> records;
+
+    recorder.Write(Recorder::SAMPLE, "Cobalt", 1, 2, 0);
+
+    EXPECT_EQ(recorder.Written(), 0u);
+    EXPECT_EQ(recorder.Read(records), 0u);
+    EXPECT_TRUE(records.empty());
+}
+
+TEST(MonitorRecorder, CapacityRoundedUpToPowerOfTwo)
+{
+    Recorder recorder;
+
+    recorder.Open(100);
+    EXPECT_EQ(recorder.Capacity(), 128u);
+
+    recorder.Open(0);
+    EXPECT_EQ(recorder.Capacity(), 1u);
+}
+
+TEST(MonitorRecorder, RecordsReadBackOldestFirst)
+{
+    Clock::Manual clock(1000);
+    Recorder recorder;
+    std::vector<Recorder::Record> records;
+
+    Clock::Assign(&clock);
+    recorder.Open(8);
+
+    recorder.Write(Recorder::SAMPLE, "Cobalt", 2048, 4096, 0);
+    clock.Advance(10);
+    recorder.Write(Recorder::DEACTIVATE, "org.rdk.SystemAudioPlayer.Clone", 8192, 4096, 2, 1);
+
+    Clock::Assign(nullptr);
+
+    EXPECT_EQ(recorder.Read(records), 0u);
+    ASSERT_EQ(records.size(), 2u);
+
+    EXPECT_EQ(records[0].Time, 1000u);
+    EXPECT_EQ(records[0].Kind, Recorder::SAMPLE);
+    EXPECT_STREQ(records[0].Callsign, "Cobalt");
+    EXPECT_EQ(records[0].Value, 2048u);
+    EXPECT_EQ(records[0].Limit, 4096u);
+
+    EXPECT_EQ(records[1].Time, 1010u);
+    EXPECT_EQ(records[1].Kind, Recorder::DEACTIVATE);
+    EXPECT_EQ(records[1].Status, 2u);
+    EXPECT_EQ(records[1].Reason, 1u);
+    // Cut short, but terminated.
+    EXPECT_STREQ(records[1].Callsign, "org.rdk.SystemAudioPlayer");
+}
+
+TEST(MonitorRecorder, OldestOverwritten)
+{
+    Recorder recorder;
+    std::vector<Recorder::Record> records;
+
+    recorder.Open(4);
+
+    for (uint64_t index = 0; index < 10; index++) {
+        recorder.Write(Recorder::SAMPLE, "Cobalt", index, 0, 0);
+    }
+
+    EXPECT_EQ(recorder.Written(), 10u);
+    EXPECT_EQ(recorder.Read(records), 6u);
+    ASSERT_EQ(records.size(), 4u);
+    EXPECT_EQ(records.front().Value, 6u);
+    EXPECT_EQ(records.back().Value, 9u);
+}
+
+TEST(MonitorRecorder, ConcurrentWritersLeaveWholeRecords)
+{
+    static constexpr uint32_t Writers = 4;
+    static constexpr uint64_t Count = 20000;
+
+    Recorder recorder;
+    std::vector<std::thread> writers;
+
+    recorder.Open(256);
+
+    for (uint32_t writer = 0; writer < Writers; writer++) {
+        writers.emplace_back([&recorder, writer]() {
+            const std::string callsign("Writer" + std::to_string(writer));
+
+            for (uint64_t index = 0; index < Count; index++) {
+                // Value and limit go together, a torn record would show.
+                recorder.Write(Recorder::SAMPLE, callsign, index, index * 2, writer);
+            }
+        });
+    }
+
+    // Reads while the writers are at it, whatever comes back is whole.
+    for (uint32_t round = 0; round < 100; round++) {
+        std::vector<Recorder::Record> records;
+
+        recorder.Read(records);
+
+        for (const Recorder::Record& record : records) {
+            EXPECT_EQ(record.Limit, record.Value * 2);
+            EXPECT_EQ(std::string(record.Callsign), "Writer" + std::to_string(record.Status));
+        }
+    }
+
+    for (std::thread& writer : writers) {
+        writer.join();
+    }
+
+    std::vector<Recorder::Record> records;
+
+    EXPECT_EQ(recorder.Written(), Writers * Count);
+    // A record that met another writer in its slot was dropped, it shows as lost.
+    EXPECT_EQ(recorder.Read(records) + records.size(), Writers * Count);
+    EXPECT_LE(records.size(), 256u);
+    EXPECT_FALSE(records.empty());
+
+    for (const Recorder::Record& record : records) {
+        EXPECT_EQ(record.Limit, record.Value * 2);
+    }
+}
@@ -0,0 +1,179 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+#include "Replay.h"
+
+using WPEFramework::Plugin::MonitorReplay;
+
+namespace {
+
+    constexpr uint64_t Second = MonitorReplay::Second;
+
+    // Intervals in seconds, limits in KiB, as in the configuration.
+    MonitorReplay::Observable::Settings Settings(const uint32_t memory, const uint64_t threshold, const uint8_t limit, const uint16_t window)
+    {
+        MonitorReplay::Observable::Settings settings {};
+
+        settings.ActOnOperational = true;
+        settings.Memory = memory * Second;
+        settings.MemoryMin = settings.Memory;
+        settings.MemoryMax = settings.Memory;
+        settings.Threshold = threshold;
+        settings.RestartLimit = limit;
+        settings.RestartWindow = window;
+
+        return (settings);
+    }
+
+    // A sample a second, resident in KiB.
+    MonitorReplay::Trace Flat(const uint32_t seconds, const uint64_t resident)
+    {
+        MonitorReplay::Trace trace;
+
+        for (uint32_t index = 0; index <= seconds; index++) {
+            trace.push_back({ index * Second, resident * 1024, 0, 0, 1, true });
+        }
+
+        return (trace);
+    }
+
+} // namespace
+
+TEST(MonitorReplay, LoadSkipsWhatDoesNotParse)
+{
+    std::istringstream input(
+        "time,callsign,resident,operational\n"
+        "# recorded on the bench\n"
+        "12.5,Cobalt,2048,1\r\n"
+        "10,Cobalt,1024,1,512,256,3\n"
+        "11,Netflix,4096,0\n"
+        "11,Netflix,lots,1\n"
+        "13,Netflix,4096\n");
+    MonitorReplay::Traces traces;
+
+    EXPECT_EQ(MonitorReplay::Load(input, traces), 4u);
+
+    ASSERT_EQ(traces.size(), 2u);
+    ASSERT_EQ(traces["Cobalt"].size(), 2u);
+    ASSERT_EQ(traces["Netflix"].size(), 1u);
+
+    const MonitorReplay::Sample& first(traces["Cobalt"][0]);
+    EXPECT_EQ(first.Time, 0u);
+    EXPECT_EQ(first.Resident, 1024u * 1024);
+    EXPECT_EQ(first.Allocated, 512u * 1024);
+    EXPECT_EQ(first.Shared, 256u * 1024);
+    EXPECT_EQ(first.Processes, 3u);
+    EXPECT_EQ(traces["Cobalt"][1].Time, 2500u * 1000);
+    EXPECT_EQ(traces["Netflix"][0].Time, 1 * Second);
+    EXPECT_FALSE(traces["Netflix"][0].Operational);
+}
+
+TEST(MonitorReplay, ExpandCoversEveryCombination)
+{
+    MonitorReplay::Grid grid;
+
+    ASSERT_TRUE(MonitorReplay::Values("100,200", grid[MonitorReplay::MEMORYLIMIT]));
+    ASSERT_TRUE(MonitorReplay::Values("1,2,3", grid[MonitorReplay::LIMIT]));
+    EXPECT_FALSE(MonitorReplay::Values("1,,3", grid[MonitorReplay::WINDOW]));
+    grid[MonitorReplay::WINDOW].clear();
+
+    const std::vector<MonitorReplay::Parameters> points(MonitorReplay::Expand(grid));
+
+    ASSERT_EQ(points.size(), 6u);
+    EXPECT_EQ(points[0].Values[MonitorReplay::MEMORYLIMIT].Value(), 100u);
+    EXPECT_EQ(points[0].Values[MonitorReplay::LIMIT].Value(), 1u);
+    EXPECT_EQ(points[5].Values[MonitorReplay::MEMORYLIMIT].Value(), 200u);
+    EXPECT_EQ(points[5].Values[MonitorReplay::LIMIT].Value(), 3u);
+    EXPECT_FALSE(points[5].Values[MonitorReplay::WINDOW].IsSet());
+
+    const MonitorReplay::Observable::Settings settings(points[5].Apply(Settings(1, 50, 0, 60)));
+    EXPECT_EQ(settings.Threshold, 200u);
+    EXPECT_EQ(settings.RestartLimit, 3u);
+    EXPECT_EQ(settings.RestartWindow, 60u);
+
+    EXPECT_EQ(MonitorReplay::Expand(MonitorReplay::Grid()).size(), 1u);
+}
+
+TEST(MonitorReplay, RestartsUntilTheLimit)
+{
+    const MonitorReplay::Trace trace(Flat(100, 2048));
+    MonitorReplay::Outcome outcome { "Observed", 0, 0, 0, 0, 0, 0, {} };
+
+    // Over the limit from the first sample, back 5 seconds after every restart.
+    MonitorReplay::Replay(trace, Settings(1, 1024, 2, 60), 5 * Second, outcome);
+
+    EXPECT_EQ(outcome.Deactivations, 3u);
+    EXPECT_EQ(outcome.Restarts, 2u);
+    EXPECT_EQ(outcome.GiveUps, 1u);
+    ASSERT_EQ(outcome.Events.size(), 6u);
+    EXPECT_EQ(outcome.Events[0].Action, "Deactivate");
+    EXPECT_EQ(outcome.Events[0].Time, 0u);
+    EXPECT_EQ(outcome.Events[2].Time, 5 * Second);
+    EXPECT_EQ(outcome.Events[5].Action, "StoppedRestaring");
+    EXPECT_EQ(outcome.Down, 100 * Second);
+}
+
+TEST(MonitorReplay, NothingHappensBelowTheLimit)
+{
+    const MonitorReplay::Trace trace(Flat(100, 512));
+    MonitorReplay::Outcome outcome { "Observed", 0, 0, 0, 0, 0, 0, {} };
+
+    MonitorReplay::Replay(trace, Settings(1, 1024, 2, 60), 5 * Second, outcome);
+
+    EXPECT_EQ(outcome.Deactivations, 0u);
+    EXPECT_TRUE(outcome.Events.empty());
+    EXPECT_EQ(outcome.Down, 0u);
+}
+
+TEST(MonitorReplay, SweepMatchesReplayingOneByOne)
+{
+    MonitorReplay::Traces traces;
+    traces["Low"] = Flat(300, 512);
+    traces["High"] = Flat(300, 2048);
+
+    const std::vector<std::pair<std::string, MonitorReplay::Observable::Settings>> observables {
+        { "High", Settings(1, 1024, 3, 10) },
+        { "Low", Settings(1, 1024, 3, 10) },
+        { "Untraced", Settings(1, 1024, 3, 10) }
+    };
+
+    MonitorReplay::Grid grid;
+    grid[MonitorReplay::WINDOW] = { 10, 30, 60, 120 };
+    grid[MonitorReplay::MEMORYLIMIT] = { 256, 1024, 4096 };
+
+    const std::vector<MonitorReplay::Parameters> points(MonitorReplay::Expand(grid));
+    const std::vector<MonitorReplay::Outcome> outcomes(MonitorReplay::Sweep(observables, traces, points, 5 * Second, 4));
+
+    ASSERT_EQ(outcomes.size(), points.size() * 2);
+
+    for (const MonitorReplay::Outcome& outcome : outcomes) {
+        MonitorReplay::Outcome expected { outcome.Callsign, outcome.Set, 0, 0, 0, 0, 0, {} };
+
+        MonitorReplay::Replay(traces[outcome.Callsign], points[outcome.Set].Apply(observables[outcome.Callsign == "High" ? 0 : 1].second), 5 * Second, expected);
+
+        EXPECT_EQ(outcome.Deactivations, expected.Deactivations);
+        EXPECT_EQ(outcome.Restarts, expected.Restarts);
+        EXPECT_EQ(outcome.GiveUps, expected.GiveUps);
+        EXPECT_EQ(outcome.Down, expected.Down);
+    }
+}
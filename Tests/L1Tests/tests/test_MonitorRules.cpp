@@ -0,0 +1,304 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "Rules.h"
+
+using namespace WPEFramework::Plugin;
+
+static constexpr uint64_t Second = 1000 * 1000;
+
+TEST(MonitorViolation, DefaultFiresOnFirstFailure)
+{
+    Violation rule;
+
+    EXPECT_EQ(1, rule.Samples());
+    EXPECT_EQ(1, rule.Window());
+    EXPECT_FALSE(rule.Set(false, 1 * Second));
+    EXPECT_TRUE(rule.Set(true, 2 * Second));
+    EXPECT_FALSE(rule.Set(false, 3 * Second));
+}
+
+TEST(MonitorViolation, NOfMIgnoresIsolatedSpikes)
+{
+    Violation rule(3, 5, 0);
+
+    EXPECT_FALSE(rule.Set(true, 1 * Second));
+    EXPECT_FALSE(rule.Set(false, 2 * Second));
+    EXPECT_FALSE(rule.Set(true, 3 * Second));
+    EXPECT_FALSE(rule.Set(false, 4 * Second));
+    EXPECT_TRUE(rule.Set(true, 5 * Second));
+}
+
+TEST(MonitorViolation, NOfMForgetsSamplesOutsideTheWindow)
+{
+    Violation rule(2, 3, 0);
+
+    EXPECT_FALSE(rule.Set(true, 1 * Second));
+    EXPECT_FALSE(rule.Set(false, 2 * Second));
+    EXPECT_FALSE(rule.Set(false, 3 * Second));
+    EXPECT_FALSE(rule.Set(true, 4 * Second));
+    EXPECT_TRUE(rule.Set(true, 5 * Second));
+}
+
+TEST(MonitorViolation, DoesNotFireOnAPassingSample)
+{
+    Violation rule(2, 4, 0);
+
+    EXPECT_FALSE(rule.Set(true, 1 * Second));
+    EXPECT_TRUE(rule.Set(true, 2 * Second));
+    EXPECT_FALSE(rule.Set(false, 3 * Second));
+    EXPECT_TRUE(rule.Set(true, 4 * Second));
+}
+
+TEST(MonitorViolation, SustainRequiresAnUninterruptedRun)
+{
+    Violation rule(1, 1, 10 * Second);
+
+    EXPECT_FALSE(rule.Set(true, 0 * Second));
+    EXPECT_FALSE(rule.Set(true, 5 * Second));
+    EXPECT_FALSE(rule.Set(false, 9 * Second));
+    EXPECT_FALSE(rule.Set(true, 11 * Second));
+    EXPECT_FALSE(rule.Set(true, 20 * Second));
+    EXPECT_TRUE(rule.Set(true, 21 * Second));
+}
+
+TEST(MonitorViolation, SustainAndNOfMCombine)
+{
+    Violation rule(3, 3, 4 * Second);
+
+    EXPECT_FALSE(rule.Set(true, 0 * Second));
+    EXPECT_FALSE(rule.Set(true, 1 * Second));
+    EXPECT_FALSE(rule.Set(true, 2 * Second));
+    EXPECT_TRUE(rule.Set(true, 4 * Second));
+}
+
+TEST(MonitorViolation, ResetForgetsHistory)
+{
+    Violation rule(2, 2, 0);
+
+    EXPECT_FALSE(rule.Set(true, 1 * Second));
+    rule.Reset();
+    EXPECT_FALSE(rule.Set(true, 2 * Second));
+    EXPECT_TRUE(rule.Set(true, 3 * Second));
+}
+
+TEST(MonitorViolation, BoundsAreClamped)
+{
+    Violation zero(0, 0, 0);
+    EXPECT_EQ(1, zero.Samples());
+    EXPECT_EQ(1, zero.Window());
+
+    Violation wide(40, 64, 0);
+    EXPECT_EQ(static_cast<uint8_t>(Violation::MaxWindow), wide.Window());
+    EXPECT_EQ(static_cast<uint8_t>(Violation::MaxWindow), wide.Samples());
+
+    Violation inverted(5, 3, 0);
+    EXPECT_EQ(3, inverted.Samples());
+}
+
+TEST(MonitorViolation, FullWindowCountsEverySample)
+{
+    Violation rule(Violation::MaxWindow, Violation::MaxWindow, 0);
+
+    for (uint8_t index = 1; index < Violation::MaxWindow; index++) {
+        EXPECT_FALSE(rule.Set(true, index * Second));
+    }
+    EXPECT_TRUE(rule.Set(true, Violation::MaxWindow * Second));
+}
+
+TEST(MonitorHysteresis, WithoutClearanceFollowsTheThreshold)
+{
+    Hysteresis band;
+
+    EXPECT_FALSE(band.Above(100, 100));
+    EXPECT_TRUE(band.Above(101, 100));
+    EXPECT_FALSE(band.Above(100, 100));
+}
+
+TEST(MonitorHysteresis, StaysAboveUntilClearedByTheBand)
+{
+    Hysteresis band(10);
+
+    EXPECT_FALSE(band.Above(950, 1000));
+    EXPECT_TRUE(band.Above(1001, 1000));
+    EXPECT_TRUE(band.Above(950, 1000));
+    EXPECT_TRUE(band.Above(901, 1000));
+    EXPECT_FALSE(band.Above(900, 1000));
+    EXPECT_FALSE(band.Above(950, 1000));
+}
+
+TEST(MonitorHysteresis, ResetDropsTheState)
+{
+    Hysteresis band(50);
+
+    EXPECT_TRUE(band.Above(200, 100));
+    band.Reset();
+    EXPECT_FALSE(band.Above(80, 100));
+}
+
+TEST(MonitorHysteresis, ClearanceIsClamped)
+{
+    Hysteresis band(150);
+
+    EXPECT_EQ(100, band.Clearance());
+    EXPECT_TRUE(band.Above(2, 1));
+    EXPECT_TRUE(band.Above(1, 1));
+    EXPECT_FALSE(band.Above(0, 1));
+}
+
+TEST(MonitorCadence, BoundsArePowersOfTwoOfMin)
+{
+    Cadence cadence(10, 100, 30);
+
+    EXPECT_EQ(10u, cadence.Min());
+    EXPECT_EQ(80u, cadence.Max());
+    EXPECT_EQ(20u, cadence.Interval());
+}
+
+TEST(MonitorCadence, StartIsClampedToTheBounds)
+{
+    Cadence low(10, 80, 1);
+    EXPECT_EQ(10u, low.Interval());
+
+    Cadence high(10, 80, 1000);
+    EXPECT_EQ(80u, high.Interval());
+}
+
+TEST(MonitorCadence, FlatAndFarBelowTheLimitSlowsDown)
+{
+    Cadence cadence(10, 40, 10);
+
+    EXPECT_EQ(10u, cadence.Set(1000, 10000));
+    EXPECT_EQ(20u, cadence.Set(1000, 10000));
+    EXPECT_EQ(40u, cadence.Set(1005, 10000));
+    EXPECT_EQ(40u, cadence.Set(1000, 10000));
+}
+
+TEST(MonitorCadence, WithoutLimitFlatSlowsDown)
+{
+    Cadence cadence(10, 20, 10);
+
+    EXPECT_EQ(10u, cadence.Set(1000, 0));
+    EXPECT_EQ(20u, cadence.Set(1000, 0));
+}
+
+TEST(MonitorCadence, SwingSpeedsUp)
+{
+    Cadence cadence(10, 80, 80);
+
+    EXPECT_EQ(80u, cadence.Set(1000, 10000));
+    EXPECT_EQ(40u, cadence.Set(1100, 10000));
+    EXPECT_EQ(20u, cadence.Set(1000, 10000));
+    EXPECT_EQ(10u, cadence.Set(1100, 10000));
+    EXPECT_EQ(10u, cadence.Set(1000, 10000));
+}
+
+TEST(MonitorCadence, NearTheLimitSamplesAtMin)
+{
+    Cadence cadence(10, 80, 80);
+
+    EXPECT_EQ(80u, cadence.Set(7900, 10000));
+    EXPECT_EQ(10u, cadence.Set(8000, 10000));
+}
+
+TEST(MonitorCadence, ProjectedToReachTheLimitSamplesAtMin)
+{
+    Cadence cadence(10, 80, 80);
+
+    EXPECT_EQ(80u, cadence.Set(4000, 10000));
+    EXPECT_EQ(10u, cadence.Set(7000, 10000));
+}
+
+TEST(MonitorCadence, FallingIsNotProjectedToReachTheLimit)
+{
+    Cadence cadence(10, 80, 80);
+
+    EXPECT_EQ(80u, cadence.Set(7000, 10000));
+    EXPECT_EQ(40u, cadence.Set(4000, 10000));
+    EXPECT_EQ(80u, cadence.Set(4000, 10000));
+}
+
+TEST(MonitorCadence, SteadyBetweenFarAndNearKeepsTheInterval)
+{
+    Cadence cadence(10, 80, 20);
+
+    EXPECT_EQ(20u, cadence.Set(6000, 10000));
+    EXPECT_EQ(20u, cadence.Set(6000, 10000));
+}
+
+TEST(MonitorCadence, ResetSkipsTheComparisonWithTheOldValue)
+{
+    Cadence cadence(10, 80, 40);
+
+    EXPECT_EQ(40u, cadence.Set(1000, 10000));
+    cadence.Reset();
+    EXPECT_EQ(40u, cadence.Set(3000, 10000));
+}
+
+TEST(MonitorRestarts, LimitWithinWindow)
+{
+    Restarts restarts;
+
+    EXPECT_TRUE(restarts.Register(3, 10, 1 * Second));
+    EXPECT_TRUE(restarts.Register(3, 10, 2 * Second));
+    EXPECT_TRUE(restarts.Register(3, 10, 3 * Second));
+    EXPECT_FALSE(restarts.Register(3, 10, 4 * Second));
+}
+
+TEST(MonitorRestarts, WindowOpensWithTheFirstRestart)
+{
+    Restarts restarts;
+
+    EXPECT_TRUE(restarts.Register(2, 10, 1 * Second));
+    EXPECT_TRUE(restarts.Register(2, 10, 10 * Second));
+    EXPECT_TRUE(restarts.Register(2, 10, 11 * Second));
+    EXPECT_EQ(1u, restarts.Count());
+    EXPECT_TRUE(restarts.Register(2, 10, 12 * Second));
+    EXPECT_FALSE(restarts.Register(2, 10, 13 * Second));
+}
+
+TEST(MonitorRestarts, CountStartsOverOnceGivenUp)
+{
+    Restarts restarts;
+
+    EXPECT_TRUE(restarts.Register(1, 10, 1 * Second));
+    EXPECT_FALSE(restarts.Register(1, 10, 2 * Second));
+    EXPECT_EQ(0u, restarts.Count());
+    EXPECT_TRUE(restarts.Register(1, 10, 3 * Second));
+}
+
+TEST(MonitorRestarts, NoLimitAlwaysAllows)
+{
+    Restarts restarts;
+
+    for (uint8_t index = 1; index <= 100; index++) {
+        EXPECT_TRUE(restarts.Register(0, 10, index * Second));
+    }
+}
+
+TEST(MonitorRestarts, NoWindowNeverCloses)
+{
+    Restarts restarts;
+
+    EXPECT_TRUE(restarts.Register(2, 0, 1 * Second));
+    EXPECT_TRUE(restarts.Register(2, 0, 1000 * Second));
+    EXPECT_FALSE(restarts.Register(2, 0, 100000 * Second));
+}
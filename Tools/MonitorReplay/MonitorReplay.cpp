@@ -0,0 +1,232 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MODULE_NAME
+#define MODULE_NAME Tool_MonitorReplay
+#endif
+
+#include "Replay.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+MODULE_NAME_DECLARATION(BUILD_REFERENCE)
+
+using namespace WPEFramework;
+using Replay = Plugin::MonitorReplay;
+
+namespace {
+
+    // The plugin configuration as Thunder keeps it, the Monitor part stays text.
+    class PluginConfig : public Core::JSON::Container {
+    public:
+        PluginConfig(const PluginConfig&) = delete;
+        PluginConfig& operator=(const PluginConfig&) = delete;
+
+        PluginConfig()
+            : Core::JSON::Container()
+        {
+            Add(_T("configuration"), &Configuration);
+        }
+        ~PluginConfig() override = default;
+
+    public:
+        Core::JSON::String Configuration;
+    };
+
+    void Usage(const char* name)
+    {
+        std::cerr << "Usage: " << name << " --config <file> --trace <file> [options]" << std::endl
+                  << std::endl
+                  << "Replays recorded traces through the Monitor rules and reports when it would have" << std::endl
+                  << "deactivated, restarted or given up on each plugin." << std::endl
+                  << std::endl
+                  << "  --config <file>     Monitor configuration, the plugin one or only its \"configuration\"." << std::endl
+                  << "  --trace <file>      CSV of time,callsign,resident,operational[,allocated,shared,processes]," << std::endl
+                  << "                      time in seconds, sizes in KiB, operational 0 or 1. \"-\" reads stdin." << std::endl
+                  << "  --delay <seconds>   Time a restarted plugin takes to run again, 5 by default." << std::endl
+                  << "  --jobs <count>      Replays run side by side, one per core by default." << std::endl
+                  << "  --events            List every event, not only how many there were." << std::endl
+                  << std::endl
+                  << "A grid of values to replay with, comma separated, instead of the configured one:" << std::endl;
+
+        for (uint8_t index = 0; index < Replay::PARAMETERS; index++) {
+            std::cerr << "  --" << Replay::Name(static_cast<Replay::parameter>(index)) << std::endl;
+        }
+    }
+
+    bool Read(const string& file, string& content)
+    {
+        std::ifstream input(file);
+        std::stringstream buffer;
+
+        buffer << input.rdbuf();
+        content = buffer.str();
+
+        return (input.good() == true);
+    }
+
+    string Seconds(const uint64_t time /* MicroSeconds */)
+    {
+        return (std::to_string(time / Replay::Second) + '.' + std::to_string(1000 + ((time % Replay::Second) / 1000)).substr(1));
+    }
+
+    void Report(std::ostream& output, const std::vector<Replay::Parameters>& points, const std::vector<Replay::Outcome>& outcomes, const bool events)
+    {
+        std::vector<Replay::Outcome>::const_iterator outcome(outcomes.begin());
+
+        output << "{\"sets\":[";
+
+        for (uint32_t point = 0; point < points.size(); point++) {
+            bool first = true;
+
+            output << (point != 0 ? "," : "") << "{\"parameters\":{";
+            for (uint8_t index = 0; index < Replay::PARAMETERS; index++) {
+                if (points[point].Values[index].IsSet() == true) {
+                    output << (first ? "" : ",") << '"' << Replay::Name(static_cast<Replay::parameter>(index)) << "\":" << points[point].Values[index].Value();
+                    first = false;
+                }
+            }
+            output << "},\"observables\":[";
+
+            first = true;
+            for (; (outcome != outcomes.end()) && (outcome->Set == point); ++outcome) {
+                output << (first ? "" : ",") << "{\"callsign\":\"" << outcome->Callsign << '"'
+                       << ",\"deactivations\":" << outcome->Deactivations
+                       << ",\"restarts\":" << outcome->Restarts
+                       << ",\"giveups\":" << outcome->GiveUps
+                       << ",\"pressure\":" << outcome->Pressure
+                       << ",\"down\":" << Seconds(outcome->Down);
+
+                if (events == true) {
+                    output << ",\"events\":[";
+                    for (uint32_t index = 0; index < outcome->Events.size(); index++) {
+                        const Replay::Event& event(outcome->Events[index]);
+
+                        output << (index != 0 ? "," : "") << "{\"time\":" << Seconds(event.Time) << ",\"action\":\"" << event.Action << '"';
+                        if (event.Reason.empty() == false) {
+                            output << ",\"reason\":\"" << event.Reason << '"';
+                        }
+                        output << '}';
+                    }
+                    output << ']';
+                }
+
+                output << '}';
+                first = false;
+            }
+
+            output << "]}";
+        }
+
+        output << "]}" << std::endl;
+    }
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    string configFile;
+    string traceFile;
+    uint64_t delay = 5 * Replay::Second;
+    uint32_t jobs = std::max(1U, std::thread::hardware_concurrency());
+    bool events = false;
+    bool valid = true;
+    Replay::Grid grid;
+
+    for (int index = 1; (valid == true) && (index < argc); index++) {
+        const string option(argv[index]);
+        const bool value = ((index + 1) < argc);
+        std::vector<uint32_t> values;
+
+        if ((option == _T("--config")) && (value == true)) {
+            configFile = argv[++index];
+        } else if ((option == _T("--trace")) && (value == true)) {
+            traceFile = argv[++index];
+        } else if ((option == _T("--delay")) && (value == true)) {
+            valid = ((Replay::Values(argv[++index], values) == true) && (values.size() == 1));
+            delay = (valid == true ? values[0] * Replay::Second : delay);
+        } else if ((option == _T("--jobs")) && (value == true)) {
+            valid = ((Replay::Values(argv[++index], values) == true) && (values.size() == 1) && (values[0] != 0));
+            jobs = (valid == true ? values[0] : jobs);
+        } else if (option == _T("--events")) {
+            events = true;
+        } else {
+            uint8_t which = 0;
+
+            while ((which < Replay::PARAMETERS) && (option != (string(_T("--")) + Replay::Name(static_cast<Replay::parameter>(which))))) {
+                which++;
+            }
+
+            valid = ((which < Replay::PARAMETERS) && (value == true) && (Replay::Values(argv[++index], grid[which]) == true));
+        }
+    }
+
+    if ((valid == false) || (configFile.empty() == true) || (traceFile.empty() == true)) {
+        Usage(argv[0]);
+        return (1);
+    }
+
+    string configuration;
+    if (Read(configFile, configuration) == false) {
+        std::cerr << "Could not read " << configFile << std::endl;
+        return (1);
+    }
+
+    PluginConfig plugin;
+    if ((plugin.FromString(configuration) == true) && (plugin.Configuration.IsSet() == true)) {
+        configuration = plugin.Configuration.Value();
+    }
+
+    const std::vector<std::pair<string, Replay::Observable::Settings>> observables(Replay::Observables(configuration));
+
+    Replay::Traces traces;
+    uint32_t skipped;
+
+    if (traceFile == _T("-")) {
+        skipped = Replay::Load(std::cin, traces);
+    } else {
+        std::ifstream input(traceFile);
+
+        if (input.is_open() == false) {
+            std::cerr << "Could not read " << traceFile << std::endl;
+            return (1);
+        }
+
+        skipped = Replay::Load(input, traces);
+    }
+
+    if (skipped != 0) {
+        std::cerr << "Skipped " << skipped << " lines of " << traceFile << std::endl;
+    }
+    for (const auto& observable : observables) {
+        if (traces.find(observable.first) == traces.end()) {
+            std::cerr << "No trace for " << observable.first << std::endl;
+        }
+    }
+
+    const std::vector<Replay::Parameters> points(Replay::Expand(grid));
+
+    Report(std::cout, points, Replay::Sweep(observables, traces, points, delay, jobs), events);
+
+    Core::Singleton::Dispose();
+
+    return (0);
+}
@@ -0,0 +1,493 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __MONITOR_REPLAY_H
+#define __MONITOR_REPLAY_H
+
+#include "Monitor.h"
+
+#include <array>
+#include <atomic>
+#include <istream>
+#include <map>
+#include <thread>
+#include <vector>
+
+namespace WPEFramework {
+namespace Plugin {
+
+    // Plays recorded traces through the MonitorObject the plugin uses, on a
+    // manual clock per replay, and reports what the Monitor would have done:
+    // deactivations, restarts and giving up on them. Each replay steps from one
+    // slot of the observable to the next, so an hour of trace takes as long as
+    // the probes within it take to evaluate.
+    class MonitorReplay {
+    public:
+        using Observable = Monitor::MonitorObjects::MonitorObject;
+
+        static constexpr uint64_t Second = 1000 * 1000;
+
+        // What an observable reported at a moment, the latest one holds until the next.
+        struct Sample {
+            uint64_t Time; //!< MicroSeconds since the start of the trace.
+            uint64_t Resident; //!< Bytes, as are Allocated and Shared.
+            uint64_t Allocated;
+            uint64_t Shared;
+            uint8_t Processes;
+            bool Operational;
+        };
+        using Trace = std::vector<Sample>;
+        using Traces = std::map<string, Trace>;
+
+        // The settings a grid can sweep, named after their configuration keys.
+        enum parameter : uint8_t {
+            MEMORYLIMIT = 0,
+            MEMORYSOFTLIMIT = 1,
+            MEMORYGRACE = 2,
+            SAMPLES = 3,
+            SUSTAIN = 4,
+            WINDOW = 5,
+            LIMIT = 6,
+            PARAMETERS = 7
+        };
+        using Grid = std::array<std::vector<uint32_t>, PARAMETERS>;
+
+        // One point of the grid. Whatever is not set keeps the configured value.
+        struct Parameters {
+            Core::OptionalType<uint32_t> Values[PARAMETERS];
+
+            Observable::Settings Apply(const Observable::Settings& configured) const
+            {
+                Observable::Settings settings(configured);
+
+                if (Values[MEMORYLIMIT].IsSet() == true) {
+                    settings.Threshold = Values[MEMORYLIMIT].Value();
+                }
+                if (Values[MEMORYSOFTLIMIT].IsSet() == true) {
+                    settings.SoftThreshold = Values[MEMORYSOFTLIMIT].Value();
+                }
+                if (Values[MEMORYGRACE].IsSet() == true) {
+                    settings.Grace = static_cast<uint64_t>(Values[MEMORYGRACE].Value()) * Second;
+                }
+                if ((Values[SAMPLES].IsSet() == true) || (Values[SUSTAIN].IsSet() == true)) {
+                    const uint8_t samples(Values[SAMPLES].IsSet() == true ? static_cast<uint8_t>(Values[SAMPLES].Value()) : configured.Rule.Samples());
+                    const uint64_t sustain(Values[SUSTAIN].IsSet() == true ? static_cast<uint64_t>(Values[SUSTAIN].Value()) * Second : configured.Rule.Sustain());
+
+                    // The window grows along, so the samples asked for still fit in.
+                    settings.Rule = Violation(samples, std::max(samples, configured.Rule.Window()), sustain);
+                }
+                if (Values[WINDOW].IsSet() == true) {
+                    settings.RestartWindow = static_cast<uint16_t>(Values[WINDOW].Value());
+                }
+                if (Values[LIMIT].IsSet() == true) {
+                    settings.RestartLimit = static_cast<uint8_t>(Values[LIMIT].Value());
+                }
+
+                return (settings);
+            }
+        };
+
+        struct Event {
+            uint64_t Time; //!< MicroSeconds since the start of the trace.
+            string Action; //!< As the Monitor reports it in its action event.
+            string Reason;
+        };
+
+        // What the Monitor would have done to one observable with one point of the grid.
+        struct Outcome {
+            string Callsign;
+            uint32_t Set; //!< Index of the point of the grid.
+            uint32_t Deactivations;
+            uint32_t Restarts;
+            uint32_t GiveUps;
+            uint32_t Pressure;
+            uint64_t Down; //!< MicroSeconds the observable was not running.
+            std::vector<Event> Events;
+        };
+
+    private:
+        // The memory interface of the observable, answering from the trace.
+        class Playback : public Exchange::IMemory {
+        public:
+            Playback() = delete;
+            Playback(const Playback&) = delete;
+            Playback& operator=(const Playback&) = delete;
+
+            explicit Playback(const Trace& trace)
+                : _trace(trace)
+                , _index(0)
+            {
+                ASSERT(trace.empty() == false);
+            }
+            ~Playback() override = default;
+
+        public:
+            // Moves to the latest sample at or before now.
+            inline void Seek(const uint64_t now)
+            {
+                while (((_index + 1) < _trace.size()) && (_trace[_index + 1].Time <= now)) {
+                    _index++;
+                }
+            }
+
+            uint64_t Resident() const override
+            {
+                return (_trace[_index].Resident);
+            }
+            uint64_t Allocated() const override
+            {
+                return (_trace[_index].Allocated);
+            }
+            uint64_t Shared() const override
+            {
+                return (_trace[_index].Shared);
+            }
+            uint8_t Processes() const override
+            {
+                return (_trace[_index].Processes);
+            }
+            const bool IsOperational() const override
+            {
+                return (_trace[_index].Operational);
+            }
+
+            BEGIN_INTERFACE_MAP(Playback)
+            INTERFACE_ENTRY(Exchange::IMemory)
+            END_INTERFACE_MAP
+
+        private:
+            const Trace& _trace;
+            size_t _index;
+        };
+
+    public:
+        MonitorReplay() = delete;
+        MonitorReplay(const MonitorReplay&) = delete;
+        MonitorReplay& operator=(const MonitorReplay&) = delete;
+
+        static const TCHAR* Name(const parameter which)
+        {
+            static const TCHAR* const names[PARAMETERS] = {
+                _T("memorylimit"),
+                _T("memorysoftlimit"),
+                _T("memorygrace"),
+                _T("samples"),
+                _T("sustain"),
+                _T("window"),
+                _T("limit")
+            };
+
+            return (names[which]);
+        }
+
+        // Lines of "time,callsign,resident,operational[,allocated,shared,processes]", time in
+        // seconds, sizes in KiB, operational 0 or 1. Headers, comments and anything else that
+        // does not parse are skipped, their count is returned. Times start at 0 for the first
+        // sample of any observable, so all traces share one time line.
+        static uint32_t Load(std::istream& input, Traces& traces)
+        {
+            uint32_t skipped = 0;
+            double origin = -1;
+            std::map<string, std::vector<std::pair<double, Sample>>> lines;
+            string line;
+
+            while (std::getline(input, line)) {
+                std::vector<string> fields;
+                size_t start = 0;
+                size_t end;
+
+                if ((line.empty() == false) && (line.back() == '\r')) {
+                    line.pop_back();
+                }
+
+                while ((end = line.find(',', start)) != string::npos) {
+                    fields.push_back(line.substr(start, end - start));
+                    start = end + 1;
+                }
+                fields.push_back(line.substr(start));
+
+                double time;
+                Sample sample{};
+                sample.Processes = 1;
+
+                if ((fields.size() < 4) || (fields[0].empty() == true) || (fields[0][0] == '#') || (Number(fields[0], time) == false) || (time < 0)
+                    || (Number(fields[2], sample.Resident) == false) || ((fields[3] != _T("0")) && (fields[3] != _T("1")))
+                    || ((fields.size() > 4) && (Number(fields[4], sample.Allocated) == false))
+                    || ((fields.size() > 5) && (Number(fields[5], sample.Shared) == false))) {
+                    skipped++;
+                } else {
+                    uint64_t processes;
+
+                    if ((fields.size() > 6) && (Number(fields[6], processes) == true)) {
+                        sample.Processes = static_cast<uint8_t>(std::min(processes, static_cast<uint64_t>(0xFF)));
+                    }
+
+                    sample.Resident *= 1024;
+                    sample.Allocated *= 1024;
+                    sample.Shared *= 1024;
+                    sample.Operational = (fields[3] == _T("1"));
+
+                    if ((origin < 0) || (time < origin)) {
+                        origin = time;
+                    }
+
+                    lines[fields[1]].emplace_back(time, sample);
+                }
+            }
+
+            for (auto& entry : lines) {
+                Trace& trace(traces[entry.first]);
+
+                std::stable_sort(entry.second.begin(), entry.second.end(),
+                    [](const std::pair<double, Sample>& lhs, const std::pair<double, Sample>& rhs) { return (lhs.first < rhs.first); });
+
+                trace.reserve(trace.size() + entry.second.size());
+                for (auto& element : entry.second) {
+                    element.second.Time = static_cast<uint64_t>((element.first - origin) * Second);
+                    trace.push_back(element.second);
+                }
+            }
+
+            return (skipped);
+        }
+
+        // Comma separated values, false if any of them is no number.
+        static bool Values(const string& list, std::vector<uint32_t>& values)
+        {
+            bool result = true;
+            size_t start = 0;
+
+            values.clear();
+
+            while ((result == true) && (start <= list.length())) {
+                size_t end = list.find(',', start);
+                uint64_t value;
+
+                if (end == string::npos) {
+                    end = list.length();
+                }
+
+                result = ((Number(list.substr(start, end - start), value) == true) && (value <= static_cast<uint32_t>(~0)));
+
+                if (result == true) {
+                    values.push_back(static_cast<uint32_t>(value));
+                }
+
+                start = end + 1;
+            }
+
+            return (result);
+        }
+
+        // Every combination of the values given, a single point with nothing set for an empty grid.
+        static std::vector<Parameters> Expand(const Grid& grid)
+        {
+            std::vector<Parameters> result(1);
+
+            for (uint8_t index = 0; index < PARAMETERS; index++) {
+                if (grid[index].empty() == false) {
+                    std::vector<Parameters> expanded;
+
+                    expanded.reserve(result.size() * grid[index].size());
+
+                    for (const Parameters& point : result) {
+                        for (const uint32_t value : grid[index]) {
+                            expanded.push_back(point);
+                            expanded.back().Values[index] = value;
+                        }
+                    }
+
+                    result.swap(expanded);
+                }
+            }
+
+            return (result);
+        }
+
+        // Replays one trace. A deactivated observable is back delay MicroSeconds after
+        // its restart, and runs on with the trace from there. One that is not restarted
+        // stays down for the rest of the trace.
+        static void Replay(const Trace& trace, const Observable::Settings& settings, const uint64_t delay, Outcome& outcome)
+        {
+            ASSERT(trace.empty() == false);
+            ASSERT((settings.Operational != 0) || (settings.Memory != 0));
+
+            // The trace is moved up, as a time of 0 reads as unset to the sustain and grace bookkeeping.
+            const uint64_t end(Origin + trace.back().Time);
+            Clock::Manual clock(Origin + trace.front().Time);
+            Core::Sink<Playback> playback(trace);
+            uint64_t resume = 0;
+            uint64_t down = 0;
+            bool running = true;
+
+            Clock::Local(&clock);
+
+            Observable observable(outcome.Callsign, settings, clock.Now());
+            observable.Set(&playback);
+            observable.Active(true);
+
+            while ((observable.TimeSlot() <= end) && ((running == true) || (resume != 0))) {
+                const uint64_t now = observable.TimeSlot();
+
+                clock.Set(now);
+
+                if ((running == false) && (now >= resume)) {
+                    outcome.Down += (now - down);
+                    observable.Set(&playback);
+                    observable.Active(true);
+                    running = true;
+                    resume = 0;
+                }
+
+                if (running == true) {
+                    playback.Seek(now - Origin);
+
+                    const uint32_t status(observable.Probe());
+
+                    if ((status & Observable::MEMORY_PRESSURE) != 0) {
+                        outcome.Pressure++;
+                        outcome.Events.push_back({ now - Origin, _T("MemoryPressure"), string() });
+                    }
+
+                    if ((status & (Observable::EXCEEDED_MEMORY | Observable::NOT_OPERATIONAL)) != 0) {
+                        // The same mapping Enforce does, there is no budget and no timeout in a replay.
+                        const Observable::Notices::reason which((status & Observable::EXCEEDED_MEMORY) != 0 ? Observable::Notices::MEMORY : Observable::Notices::FAILURE);
+                        const PluginHost::IShell::reason why(which == Observable::Notices::MEMORY ? PluginHost::IShell::MEMORY_EXCEEDED : PluginHost::IShell::FAILURE);
+
+                        outcome.Deactivations++;
+                        outcome.Events.push_back({ now - Origin, _T("Deactivate"), observable.Notice().Reason(which) });
+
+                        // What Deinitialized does.
+                        observable.Set(nullptr);
+                        observable.Active(false);
+                        running = false;
+                        down = now;
+
+                        if (observable.HasRestartAllowed() == true) {
+                            if (observable.RegisterRestart(why) == false) {
+                                outcome.GiveUps++;
+                                outcome.Events.push_back({ now - Origin, _T("StoppedRestaring"), std::to_string(observable.RestartLimit()) + _T(" attempts failed within the restart window") });
+                            } else {
+                                outcome.Restarts++;
+                                outcome.Events.push_back({ now - Origin, _T("Activate"), _T("Automatic") });
+                                resume = now + delay;
+                            }
+                        }
+                    }
+                }
+
+                observable.Retrigger(now);
+            }
+
+            if (running == false) {
+                outcome.Down += (std::max(end, down) - down);
+            }
+
+            observable.Set(nullptr);
+
+            Clock::Local(nullptr);
+        }
+
+        // Replays every observable that has a trace with every point of the grid,
+        // spread over jobs threads. Outcomes come per point, observables in order.
+        static std::vector<Outcome> Sweep(const std::vector<std::pair<string, Observable::Settings>>& observables, const Traces& traces,
+            const std::vector<Parameters>& points, const uint64_t delay, const uint32_t jobs)
+        {
+            std::vector<Outcome> result;
+            std::vector<std::pair<const Trace*, Observable::Settings>> runs;
+
+            for (uint32_t point = 0; point < points.size(); point++) {
+                for (const auto& observable : observables) {
+                    Traces::const_iterator trace(traces.find(observable.first));
+
+                    if ((trace != traces.end()) && (trace->second.empty() == false)) {
+                        result.push_back({ observable.first, point, 0, 0, 0, 0, 0, {} });
+                        runs.emplace_back(&(trace->second), points[point].Apply(observable.second));
+                    }
+                }
+            }
+
+            std::atomic<size_t> next(0);
+            const auto worker = [&]() {
+                size_t index;
+
+                while ((index = next++) < runs.size()) {
+                    Replay(*(runs[index].first), runs[index].second, delay, result[index]);
+                }
+            };
+
+            const size_t count(std::max(static_cast<size_t>(1), std::min(static_cast<size_t>(jobs), runs.size())));
+            std::vector<std::thread> threads;
+
+            threads.reserve(count - 1);
+            for (size_t index = 1; index < count; index++) {
+                threads.emplace_back(worker);
+            }
+
+            worker();
+
+            for (std::thread& thread : threads) {
+                thread.join();
+            }
+
+            return (result);
+        }
+
+        // The observables of a Monitor configuration, with the settings the plugin would derive from it.
+        static std::vector<std::pair<string, Observable::Settings>> Observables(const string& configuration)
+        {
+            std::vector<std::pair<string, Observable::Settings>> result;
+            Monitor::Config config;
+
+            config.FromString(configuration);
+
+            Core::JSON::ArrayType<Monitor::Config::Entry>::Iterator index(config.Observables.Elements());
+
+            while (index.Next() == true) {
+                if ((index.Current().MetaData.Value() != 0) || (index.Current().Operational.Value() != 0)) {
+                    result.emplace_back(index.Current().Callsign.Value(), Monitor::MonitorObjects::Configuration(index.Current()));
+                }
+            }
+
+            return (result);
+        }
+
+    private:
+        static constexpr uint64_t Origin = 24ULL * 60 * 60 * Second;
+
+        template <typename NUMBER>
+        static bool Number(const string& text, NUMBER& value)
+        {
+            char* end = nullptr;
+            bool result = false;
+
+            if ((text.empty() == false) && (text[0] != '-')) {
+                const double parsed = ::strtod(text.c_str(), &end);
+                result = ((end != nullptr) && (*end == '\0') && (parsed >= 0));
+                value = static_cast<NUMBER>(parsed);
+            }
+
+            return (result);
+        }
+    };
+
+} // namespace Plugin
+} // namespace WPEFramework
+
+#endif // __MONITOR_REPLAY_H
@@ -0,0 +1,315 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __MONITOR_CGROUP_H
+#define __MONITOR_CGROUP_H
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+namespace WPEFramework {
+namespace Plugin {
+
+    // One cgroup v2 group below a root the monitor owns, e.g. /sys/fs/cgroup/monitor/<callsign>.
+    // Plain file access only, so it works just as well on a fake tree in a tmpfs.
+    class CGroup {
+    public:
+        // Counters from memory.events, they only ever go up.
+        struct Events {
+            uint64_t Low;
+            uint64_t High;
+            uint64_t Max;
+            uint64_t Oom;
+            uint64_t OomKill;
+        };
+
+        // Sizes in bytes.
+        struct Usage {
+            uint64_t Current; //!< Page cache included.
+            uint64_t Anonymous;
+            uint64_t Mapped; //!< File pages mapped into the processes.
+            uint64_t Shared;
+            uint32_t Processes;
+
+            // What the processes hold, as the resident size of a process counts it.
+            inline uint64_t Resident() const
+            {
+                return (Anonymous + Mapped);
+            }
+        };
+
+    public:
+        CGroup() = delete;
+        CGroup(const CGroup&) = delete;
+        CGroup& operator=(const CGroup&) = delete;
+
+        CGroup(const std::string& root, const std::string& name)
+            : _path(root + '/' + name)
+            , _events()
+        {
+            ::memset(&_events, 0, sizeof(_events));
+        }
+        ~CGroup()
+        {
+        }
+
+    public:
+        // Prepares the root to hold groups with the memory controller, true if it can.
+        static bool Enable(const std::string& root)
+        {
+            if ((::mkdir(root.c_str(), 0755) != 0) && (errno != EEXIST)) {
+                return (false);
+            }
+
+            // Fails on a fake tree or if it is already enabled, what the controllers file says is what counts.
+            Write(root + "/cgroup.subtree_control", "+memory");
+
+            std::string controllers;
+            return ((Read(root + "/cgroup.controllers", controllers) == true) && (Contains(controllers, "memory") == true));
+        }
+
+        inline const std::string& Path() const
+        {
+            return (_path);
+        }
+        inline std::string EventsFile() const
+        {
+            return (_path + "/memory.events");
+        }
+        bool Create()
+        {
+            return ((::mkdir(_path.c_str(), 0755) == 0) || (errno == EEXIST));
+        }
+        // Only succeeds once the processes in it are gone.
+        bool Remove()
+        {
+            return (::rmdir(_path.c_str()) == 0);
+        }
+        bool Attach(const uint32_t pid)
+        {
+            return (Write(_path + "/cgroup.procs", std::to_string(pid)));
+        }
+        // 0 lifts the limit.
+        bool Limit(const uint64_t high, const uint64_t max)
+        {
+            const bool result = Write(_path + "/memory.high", (high == 0 ? std::string("max") : std::to_string(high)));
+            return (Write(_path + "/memory.max", (max == 0 ? std::string("max") : std::to_string(max))) && result);
+        }
+        Usage Current() const
+        {
+            Usage result = { 0, 0, 0, 0, 0 };
+            std::string text;
+
+            if (Read(_path + "/memory.current", text) == true) {
+                result.Current = std::strtoull(text.c_str(), nullptr, 10);
+            }
+            if (Read(_path + "/memory.stat", text) == true) {
+                result.Anonymous = Field(text, "anon");
+                result.Mapped = Field(text, "file_mapped");
+                result.Shared = Field(text, "shmem");
+            }
+            if (Read(_path + "/cgroup.procs", text) == true) {
+                std::istringstream lines(text);
+                std::string line;
+                while (std::getline(lines, line)) {
+                    if (line.empty() == false) {
+                        result.Processes++;
+                    }
+                }
+            }
+
+            return (result);
+        }
+        Events Read() const
+        {
+            Events result = { 0, 0, 0, 0, 0 };
+            std::string text;
+
+            if (Read(EventsFile(), text) == true) {
+                result.Low = Field(text, "low");
+                result.High = Field(text, "high");
+                result.Max = Field(text, "max");
+                result.Oom = Field(text, "oom");
+                result.OomKill = Field(text, "oom_kill");
+            }
+
+            return (result);
+        }
+        // What memory.events counted since the previous call.
+        Events Changed()
+        {
+            const Events current = Read();
+            const Events result = {
+                Delta(current.Low, _events.Low),
+                Delta(current.High, _events.High),
+                Delta(current.Max, _events.Max),
+                Delta(current.Oom, _events.Oom),
+                Delta(current.OomKill, _events.OomKill)
+            };
+
+            _events = current;
+
+            return (result);
+        }
+
+    private:
+        static inline uint64_t Delta(const uint64_t current, const uint64_t previous)
+        {
+            return (current > previous ? current - previous : 0);
+        }
+        static bool Contains(const std::string& list, const std::string& word)
+        {
+            std::istringstream words(list);
+            std::string entry;
+            while (words >> entry) {
+                if (entry == word) {
+                    return (true);
+                }
+            }
+            return (false);
+        }
+        // "key value" per line, as in memory.events and memory.stat.
+        static uint64_t Field(const std::string& text, const std::string& key)
+        {
+            std::istringstream lines(text);
+            std::string name;
+            uint64_t value;
+
+            while (lines >> name >> value) {
+                if (name == key) {
+                    return (value);
+                }
+            }
+
+            return (0);
+        }
+        static bool Read(const std::string& file, std::string& text)
+        {
+            std::ifstream stream(file);
+            bool result = stream.is_open();
+
+            if (result == true) {
+                std::stringstream buffer;
+                buffer << stream.rdbuf();
+                text = buffer.str();
+            }
+
+            return (result);
+        }
+        static bool Write(const std::string& file, const std::string& text)
+        {
+            bool result = false;
+            int fd = ::open(file.c_str(), O_WRONLY | O_TRUNC | O_CLOEXEC);
+
+            if (fd >= 0) {
+                result = (::write(fd, text.c_str(), text.length()) == static_cast<ssize_t>(text.length()));
+                ::close(fd);
+            }
+
+            return (result);
+        }
+
+    private:
+        const std::string _path;
+        Events _events;
+    };
+
+    // The kernel flags a change of memory.events as a modification of the file,
+    // so an inotify descriptor in the resource monitor replaces polling it.
+    class CGroupWatch {
+    public:
+        CGroupWatch(const CGroupWatch&) = delete;
+        CGroupWatch& operator=(const CGroupWatch&) = delete;
+
+        CGroupWatch()
+            : _descriptor(::inotify_init1(IN_NONBLOCK | IN_CLOEXEC))
+        {
+        }
+        ~CGroupWatch()
+        {
+            if (_descriptor >= 0) {
+                ::close(_descriptor);
+            }
+        }
+
+    public:
+        inline bool IsValid() const
+        {
+            return (_descriptor >= 0);
+        }
+        inline int Descriptor() const
+        {
+            return (_descriptor);
+        }
+        // Watch descriptor, negative on failure.
+        int Add(const std::string& file)
+        {
+            return (::inotify_add_watch(_descriptor, file.c_str(), IN_MODIFY));
+        }
+        void Remove(const int watch)
+        {
+            ::inotify_rm_watch(_descriptor, watch);
+        }
+        // Watches that fired since the previous call, each at most once.
+        std::vector<int> Read()
+        {
+            std::vector<int> result;
+            alignas(struct inotify_event) char buffer[4096];
+            ssize_t length;
+
+            while ((length = ::read(_descriptor, buffer, sizeof(buffer))) > 0) {
+                const char* position = buffer;
+
+                while (position < (buffer + length)) {
+                    const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(position);
+
+                    if (((event->mask & IN_MODIFY) != 0) && (std::find(result.begin(), result.end(), event->wd) == result.end())) {
+                        result.push_back(event->wd);
+                    }
+
+                    position += sizeof(struct inotify_event) + event->len;
+                }
+            }
+
+            return (result);
+        }
+
+    private:
+        const int _descriptor;
+    };
+
+} // namespace Plugin
+} // namespace WPEFramework
+
+#endif // __MONITOR_CGROUP_H
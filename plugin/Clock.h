@@ -0,0 +1,134 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __MONITOR_CLOCK_H
+#define __MONITOR_CLOCK_H
+
+#include <atomic>
+#include <cstdint>
+
+#include <time.h>
+
+namespace WPEFramework {
+namespace Plugin {
+
+    // Where the Monitor takes the time from: MicroSeconds since the epoch, the
+    // same as Core::Time::Now().Ticks(). Tests assign a Manual source, so slots,
+    // sustain periods and restart windows can be stepped through exactly. A
+    // source set for a thread only goes before the assigned one, so replays can
+    // run side by side, each on its own time line.
+    class Clock {
+    public:
+        struct ISource {
+            virtual ~ISource() = default;
+
+            virtual uint64_t Now() const = 0;
+        };
+
+        class System : public ISource {
+        public:
+            System(const System&) = delete;
+            System& operator=(const System&) = delete;
+
+            System() = default;
+            ~System() override = default;
+
+        public:
+            uint64_t Now() const override
+            {
+                struct timespec now;
+                ::clock_gettime(CLOCK_REALTIME, &now);
+
+                return ((static_cast<uint64_t>(now.tv_sec) * 1000 * 1000) + (static_cast<uint64_t>(now.tv_nsec) / 1000));
+            }
+        };
+
+        // Only moves when told to.
+        class Manual : public ISource {
+        public:
+            Manual(const Manual&) = delete;
+            Manual& operator=(const Manual&) = delete;
+
+            explicit Manual(const uint64_t start /* MicroSeconds */)
+                : _now(start)
+            {
+            }
+            ~Manual() override = default;
+
+        public:
+            uint64_t Now() const override
+            {
+                return (_now);
+            }
+            inline void Set(const uint64_t now /* MicroSeconds */)
+            {
+                _now = now;
+            }
+            inline void Advance(const uint64_t duration /* MicroSeconds */)
+            {
+                _now += duration;
+            }
+
+        private:
+            std::atomic<uint64_t> _now;
+        };
+
+    public:
+        Clock() = delete;
+        Clock(const Clock&) = delete;
+        Clock& operator=(const Clock&) = delete;
+
+        static inline uint64_t Now()
+        {
+            const ISource* local = Local();
+            return (local != nullptr ? local->Now() : Current().load()->Now());
+        }
+        // nullptr goes back to the system clock. The source has to outlive its use.
+        static inline void Assign(ISource* source)
+        {
+            Current() = (source != nullptr ? source : &Default());
+        }
+        // For the calling thread only, nullptr goes back to the assigned source.
+        static inline void Local(ISource* source)
+        {
+            Local() = source;
+        }
+
+    private:
+        static System& Default()
+        {
+            static System system;
+            return (system);
+        }
+        static std::atomic<ISource*>& Current()
+        {
+            static std::atomic<ISource*> current(&Default());
+            return (current);
+        }
+        static ISource*& Local()
+        {
+            static thread_local ISource* local = nullptr;
+            return (local);
+        }
+    };
+
+} // namespace Plugin
+} // namespace WPEFramework
+
+#endif // __MONITOR_CLOCK_H
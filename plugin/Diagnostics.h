@@ -0,0 +1,319 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __MONITOR_DIAGNOSTICS_H
+#define __MONITOR_DIAGNOSTICS_H
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#ifdef ENABLE_DIAGNOSTICS_COMPRESSION
+#include <zlib.h>
+#endif
+
+#include "Clock.h"
+
+namespace WPEFramework {
+namespace Plugin {
+
+    // What /proc tells about a process tree, taken right before the Monitor shuts its
+    // host process down: smaps_rollup, status and every thread with its wait channel,
+    // for the process and all its descendants. Plain file access only, so it works
+    // just as well on a fake tree in a tmpfs.
+    class Diagnostics {
+    public:
+        Diagnostics(const Diagnostics&) = delete;
+        Diagnostics& operator=(const Diagnostics&) = delete;
+
+        explicit Diagnostics(const std::string& proc = "/proc")
+            : _proc(proc)
+        {
+        }
+        ~Diagnostics() = default;
+
+    public:
+        // Stops reading once the budget (MicroSeconds) is spent, the text then ends in a
+        // "=== truncated" line. Children are found through task/<tid>/children, one level
+        // at a time, so the host process comes first.
+        std::string Capture(const uint32_t pid, const uint64_t budget) const
+        {
+            const uint64_t deadline = Clock::Now() + budget;
+            std::vector<uint32_t> processes(1, pid);
+            std::string result;
+            bool complete = true;
+
+            for (uint32_t index = 0; (complete == true) && (index < processes.size()); index++) {
+                const std::string path(_proc + '/' + std::to_string(processes[index]));
+                const std::vector<std::string> threads(Entries(path + "/task"));
+
+                complete = (Clock::Now() < deadline);
+
+                if (complete == true) {
+                    Section(result, processes[index], "status", path + "/status");
+                    complete = (Clock::Now() < deadline);
+                }
+                if (complete == true) {
+                    Section(result, processes[index], "smaps_rollup", path + "/smaps_rollup");
+                    complete = (Clock::Now() < deadline);
+                }
+                if (complete == true) {
+                    result += "=== " + std::to_string(processes[index]) + " threads\n";
+
+                    for (uint32_t thread = 0; (complete == true) && (thread < threads.size()); thread++) {
+                        const std::string task(path + "/task/" + threads[thread]);
+                        std::string name;
+                        std::string channel;
+                        std::string children;
+
+                        Read(task + "/comm", name);
+                        Read(task + "/wchan", channel);
+
+                        result += threads[thread] + ' ' + Line(name) + ' ' + (channel.empty() == true ? std::string("-") : Line(channel)) + '\n';
+
+                        if (Read(task + "/children", children) == true) {
+                            std::istringstream list(children);
+                            uint32_t child;
+
+                            while (list >> child) {
+                                processes.push_back(child);
+                            }
+                        }
+
+                        complete = (Clock::Now() < deadline);
+                    }
+                }
+            }
+
+            if (complete == false) {
+                result += "=== truncated\n";
+            }
+
+            return (result);
+        }
+
+    private:
+        static void Section(std::string& result, const uint32_t pid, const char name[], const std::string& file)
+        {
+            std::string text;
+
+            result += "=== " + std::to_string(pid) + ' ' + name + '\n';
+
+            if (Read(file, text) == true) {
+                result += text;
+                if ((text.empty() == false) && (text.back() != '\n')) {
+                    result += '\n';
+                }
+            }
+        }
+        // The first line, without the line feed.
+        static std::string Line(const std::string& text)
+        {
+            return (text.substr(0, text.find('\n')));
+        }
+        static std::vector<std::string> Entries(const std::string& directory)
+        {
+            std::vector<std::string> result;
+            DIR* list = ::opendir(directory.c_str());
+
+            if (list != nullptr) {
+                struct dirent* entry;
+
+                while ((entry = ::readdir(list)) != nullptr) {
+                    if (entry->d_name[0] != '.') {
+                        result.push_back(entry->d_name);
+                    }
+                }
+
+                ::closedir(list);
+                std::sort(result.begin(), result.end());
+            }
+
+            return (result);
+        }
+        static bool Read(const std::string& file, std::string& text)
+        {
+            std::ifstream stream(file);
+            bool result = stream.is_open();
+
+            if (result == true) {
+                std::stringstream buffer;
+                buffer << stream.rdbuf();
+                text = buffer.str();
+            }
+
+            return (result);
+        }
+
+    private:
+        const std::string _proc;
+    };
+
+    // A directory of captures that never grows past its limit, the oldest go first.
+    // Names start with the time of the capture, so they sort oldest first as well.
+    class DiagnosticsArchive {
+    public:
+        DiagnosticsArchive(const DiagnosticsArchive&) = delete;
+        DiagnosticsArchive& operator=(const DiagnosticsArchive&) = delete;
+
+        DiagnosticsArchive()
+            : _directory()
+            , _limit(0)
+        {
+        }
+        ~DiagnosticsArchive() = default;
+
+    public:
+        static const char* Extension()
+        {
+#ifdef ENABLE_DIAGNOSTICS_COMPRESSION
+            return (".txt.gz");
+#else
+            return (".txt");
+#endif
+        }
+
+        inline bool IsValid() const
+        {
+            return (_directory.empty() == false);
+        }
+        inline const std::string& Directory() const
+        {
+            return (_directory);
+        }
+        // An empty directory turns it off, a limit (bytes) of 0 keeps only the latest capture.
+        bool Open(const std::string& directory, const uint64_t limit)
+        {
+            _directory.clear();
+            _limit = limit;
+
+            if ((directory.empty() == false) && ((::mkdir(directory.c_str(), 0755) == 0) || (errno == EEXIST))) {
+                _directory = directory;
+            }
+
+            return (IsValid());
+        }
+        // Written next to the others and renamed into place, then the oldest are removed till
+        // what is left fits the limit again. The one just written is always kept.
+        bool Store(const uint64_t time /* MicroSeconds */, const std::string& callsign, const std::string& text)
+        {
+            char stamp[24];
+            ::snprintf(stamp, sizeof(stamp), "%020llu", static_cast<unsigned long long>(time));
+
+            const std::string name(std::string(stamp) + '-' + callsign + Extension());
+            const std::string file(_directory + '/' + name);
+            const std::string temporary(_directory + "/.pending-" + name);
+            bool result = (Write(temporary, text) == true) && (::rename(temporary.c_str(), file.c_str()) == 0);
+
+            if (result == false) {
+                ::unlink(temporary.c_str());
+            } else {
+                Prune(name);
+            }
+
+            return (result);
+        }
+        // Captures in the directory, oldest first.
+        std::vector<std::string> Captures() const
+        {
+            std::vector<std::string> result;
+            DIR* list = ::opendir(_directory.c_str());
+
+            if (list != nullptr) {
+                const size_t length = ::strlen(Extension());
+                struct dirent* entry;
+
+                while ((entry = ::readdir(list)) != nullptr) {
+                    const std::string name(entry->d_name);
+
+                    if ((name[0] != '.') && (name.length() > length) && (name.compare(name.length() - length, length, Extension()) == 0)) {
+                        result.push_back(name);
+                    }
+                }
+
+                ::closedir(list);
+                std::sort(result.begin(), result.end());
+            }
+
+            return (result);
+        }
+
+    private:
+        void Prune(const std::string& kept)
+        {
+            const std::vector<std::string> captures(Captures());
+            std::vector<uint64_t> sizes;
+            uint64_t total = 0;
+
+            for (const std::string& name : captures) {
+                struct stat info;
+
+                sizes.push_back(::stat((_directory + '/' + name).c_str(), &info) == 0 ? static_cast<uint64_t>(info.st_size) : 0);
+                total += sizes.back();
+            }
+
+            for (uint32_t index = 0; (total > _limit) && (index < captures.size()); index++) {
+                if ((captures[index] != kept) && (::unlink((_directory + '/' + captures[index]).c_str()) == 0)) {
+                    total -= sizes[index];
+                }
+            }
+        }
+        static bool Write(const std::string& file, const std::string& text)
+        {
+#ifdef ENABLE_DIAGNOSTICS_COMPRESSION
+            bool result = false;
+            gzFile stream = ::gzopen(file.c_str(), "wb6");
+
+            if (stream != nullptr) {
+                result = (text.empty() == true) || (::gzwrite(stream, text.c_str(), static_cast<unsigned>(text.length())) == static_cast<int>(text.length()));
+                result = (::gzclose(stream) == Z_OK) && (result == true);
+            }
+
+            return (result);
+#else
+            std::ofstream stream(file, std::ios::out | std::ios::trunc | std::ios::binary);
+
+            stream << text;
+            stream.close();
+
+            return (stream.fail() == false);
+#endif
+        }
+
+    private:
+        std::string _directory;
+        uint64_t _limit;
+    };
+
+} // namespace Plugin
+} // namespace WPEFramework
+
+#endif // __MONITOR_DIAGNOSTICS_H
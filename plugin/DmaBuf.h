@@ -0,0 +1,226 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __MONITOR_DMABUF_H
+#define __MONITOR_DMABUF_H
+
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+namespace WPEFramework {
+namespace Plugin {
+
+    // The dma-buf memory a set of processes holds on to, graphics and video buffers
+    // that do not show in the resident size. Buffers are found through the open
+    // files of the processes, a buffer that several of them share counts once.
+    //
+    // A buffer keeps its size for as long as it lives, so the size is read once,
+    // from /sys/kernel/debug/dma_buf/bufinfo if it is there, else from the fdinfo
+    // of the file, and kept by inode. Later scans only stat the open files. Plain
+    // file access only, so it works just as well on a fake tree in a tmpfs.
+    class DmaBuf {
+    public:
+        DmaBuf(const DmaBuf&) = delete;
+        DmaBuf& operator=(const DmaBuf&) = delete;
+
+        explicit DmaBuf(const std::string& proc = "/proc", const std::string& debug = "/sys/kernel/debug/dma_buf/bufinfo")
+            : _proc(proc)
+            , _debug(debug)
+            , _buffers()
+            , _round(0)
+            , _reads(0)
+        {
+        }
+        ~DmaBuf() = default;
+
+    public:
+        // Buffers known from earlier scans.
+        inline uint32_t Cached() const
+        {
+            return (static_cast<uint32_t>(_buffers.size()));
+        }
+        // Files the latest scan had to read to find sizes.
+        inline uint32_t Reads() const
+        {
+            return (_reads);
+        }
+        void Reset()
+        {
+            _buffers.clear();
+        }
+        // Bytes, buffers that are no longer open in any of the processes are forgotten.
+        uint64_t Measure(const std::vector<uint32_t>& pids)
+        {
+            std::unordered_map<uint64_t, uint64_t> listed;
+            bool debug = false;
+            uint64_t result = 0;
+
+            _round++;
+            _reads = 0;
+
+            for (const uint32_t pid : pids) {
+                const std::string path(_proc + '/' + std::to_string(pid));
+                DIR* list = ::opendir((path + "/fd").c_str());
+
+                if (list != nullptr) {
+                    struct dirent* entry;
+
+                    while ((entry = ::readdir(list)) != nullptr) {
+                        if (entry->d_name[0] != '.') {
+                            const std::string file(path + "/fd/" + entry->d_name);
+                            char target[128];
+                            const ssize_t length = ::readlink(file.c_str(), target, sizeof(target) - 1);
+
+                            if (length > 0) {
+                                target[length] = '\0';
+                            }
+
+                            if ((length > 0) && (::strstr(target, "dmabuf") != nullptr)) {
+                                struct stat info;
+
+                                if (::strncmp(target, "anon_inode:", 11) == 0) {
+                                    // Kernels before 5.3 share one inode between all buffers, nothing
+                                    // to tell them apart by, so each file counts and is read every time.
+                                    result += Size(path + "/fdinfo/" + entry->d_name);
+                                } else if (::stat(file.c_str(), &info) == 0) {
+                                    result += Account(static_cast<uint64_t>(info.st_ino), path + "/fdinfo/" + entry->d_name, listed, debug);
+                                }
+                            }
+                        }
+                    }
+
+                    ::closedir(list);
+                }
+            }
+
+            for (std::unordered_map<uint64_t, Buffer>::iterator index = _buffers.begin(); index != _buffers.end();) {
+                if (index->second.Round != _round) {
+                    index = _buffers.erase(index);
+                } else {
+                    index++;
+                }
+            }
+
+            return (result);
+        }
+
+    private:
+        struct Buffer {
+            uint64_t Size;
+            uint32_t Round;
+        };
+
+        // The size the first time the buffer turns up in this round, 0 after that.
+        uint64_t Account(const uint64_t inode, const std::string& fdinfo, std::unordered_map<uint64_t, uint64_t>& listed, bool& debug)
+        {
+            std::unordered_map<uint64_t, Buffer>::iterator index(_buffers.find(inode));
+            uint64_t result = 0;
+
+            if (index == _buffers.end()) {
+                if (debug == false) {
+                    // Once per round at most, it lists the buffers of the whole system.
+                    debug = true;
+                    List(listed);
+                }
+
+                std::unordered_map<uint64_t, uint64_t>::const_iterator entry(listed.find(inode));
+
+                result = (entry != listed.end() ? entry->second : Size(fdinfo));
+                _buffers.emplace(inode, Buffer { result, _round });
+            } else if (index->second.Round != _round) {
+                index->second.Round = _round;
+                result = index->second.Size;
+            }
+
+            return (result);
+        }
+        // Lines of bufinfo are "size flags mode count exp_name ino ...", older kernels have no ino.
+        void List(std::unordered_map<uint64_t, uint64_t>& listed)
+        {
+            std::string text;
+
+            if (Read(_debug, text) == true) {
+                std::istringstream lines(text);
+                std::string line;
+
+                while (std::getline(lines, line)) {
+                    std::istringstream fields(line);
+                    std::string flags, mode, exporter;
+                    uint64_t size, count, inode;
+
+                    if ((line.empty() == false) && (::isdigit(static_cast<unsigned char>(line[0])) != 0) && (fields >> size >> flags >> mode >> count >> exporter >> inode)) {
+                        listed[inode] = size;
+                    }
+                }
+            }
+        }
+        uint64_t Size(const std::string& fdinfo)
+        {
+            std::string text;
+            uint64_t result = 0;
+
+            if (Read(fdinfo, text) == true) {
+                const size_t start = text.find("\nsize:");
+
+                if (start != std::string::npos) {
+                    result = std::strtoull(text.c_str() + start + 6, nullptr, 10);
+                }
+            }
+
+            return (result);
+        }
+        bool Read(const std::string& file, std::string& text)
+        {
+            std::ifstream stream(file);
+            bool result = stream.is_open();
+
+            if (result == true) {
+                std::stringstream buffer;
+                buffer << stream.rdbuf();
+                text = buffer.str();
+                _reads++;
+            }
+
+            return (result);
+        }
+
+    private:
+        const std::string _proc;
+        const std::string _debug;
+        std::unordered_map<uint64_t, Buffer> _buffers;
+        uint32_t _round;
+        uint32_t _reads;
+    };
+
+} // namespace Plugin
+} // namespace WPEFramework
+
+#endif // __MONITOR_DMABUF_H
@@ -0,0 +1,114 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __MONITOR_METRICS_H
+#define __MONITOR_METRICS_H
+
+#include <cstdint>
+#include <string>
+
+namespace WPEFramework {
+namespace Plugin {
+
+    // The metrics kept of every observable, all in one table: the name status
+    // gives them and what is kept of them on top of the lifetime min, max,
+    // average and last. Keeping the samples, the status and the fields of a
+    // projection all run over this table, so a new metric is an enumerator and
+    // a line in it, plus the place its samples come from.
+    class Metrics {
+    public:
+        enum metric : uint8_t {
+            // With a history, these come first.
+            ALLOCATED,
+            RESIDENT,
+            SHARED,
+            // Lifetime only.
+            PROCESS,
+            DMABUF,
+            METRICS
+        };
+        enum keep : uint8_t {
+            LIFETIME = 0x00,
+            HISTORY = 0x01, //!< The distribution for the quantiles and the rolling windows.
+            SPARSE = 0x02 //!< Only measured for some observables, left out of the status of the others.
+        };
+
+        struct Descriptor {
+            metric Id; //!< Its position in the table, checked at compile time.
+            const char* Name;
+            uint8_t Keep;
+        };
+
+        // Metrics with a history.
+        static constexpr uint8_t HISTORIES = 3;
+
+    public:
+        Metrics() = delete;
+        Metrics(const Metrics&) = delete;
+        Metrics& operator=(const Metrics&) = delete;
+
+    public:
+        static constexpr const Descriptor& Describe(const metric which)
+        {
+            return (Table<>::Entries[which]);
+        }
+        static constexpr bool HasHistory(const metric which)
+        {
+            return (which < HISTORIES);
+        }
+        // METRICS if there is no metric by that name.
+        static metric Find(const std::string& name)
+        {
+            uint8_t index = 0;
+
+            while ((index < METRICS) && (name != Table<>::Entries[index].Name)) {
+                index++;
+            }
+
+            return (static_cast<metric>(index));
+        }
+        // The table is complete, in the order of the enumerators, and the metrics with a history are the first HISTORIES ones.
+        static constexpr bool IsConsistent(const uint8_t index = 0)
+        {
+            return ((index == METRICS) || ((Table<>::Entries[index].Id == index) && (Table<>::Entries[index].Name != nullptr) && (((Table<>::Entries[index].Keep & HISTORY) != 0) == (index < HISTORIES)) && (IsConsistent(index + 1) == true)));
+        }
+
+    private:
+        // A template only so the table can be defined in this header.
+        template <typename DUMMY = void>
+        struct Table {
+            static constexpr Descriptor Entries[METRICS] = {
+                { ALLOCATED, "allocated", HISTORY },
+                { RESIDENT, "resident", HISTORY },
+                { SHARED, "shared", HISTORY },
+                { PROCESS, "process", LIFETIME },
+                { DMABUF, "dmabuf", SPARSE }
+            };
+        };
+    };
+
+    template <typename DUMMY>
+    constexpr Metrics::Descriptor Metrics::Table<DUMMY>::Entries[Metrics::METRICS];
+
+    static_assert(Metrics::IsConsistent() == true, "Every metric needs an entry at its own position, those with a history go first");
+
+} // namespace Plugin
+} // namespace WPEFramework
+
+#endif // __MONITOR_METRICS_H
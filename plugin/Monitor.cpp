@@ -20,7 +20,7 @@
 #include "Monitor.h"
 
 #define API_VERSION_NUMBER_MAJOR 1
-#define API_VERSION_NUMBER_MINOR 1
+#define API_VERSION_NUMBER_MINOR 2
 #define API_VERSION_NUMBER_PATCH 0
 
 namespace WPEFramework {
@@ -51,10 +51,8 @@ namespace Plugin {
 
         _skipURL = static_cast<uint8_t>(service->WebPrefix().length());
 
-        Core::JSON::ArrayType<Config::Entry>::Iterator index(_config.Observables.Elements());
-
         // Create a list of plugins to monitor..
-        _monitor.Open(service, index);
+        _monitor.Open(service, _config);
 
         // During the registartion, all Plugins, currently active are reported to the sink.
         service->Register(&_monitor);
@@ -87,12 +85,18 @@ namespace Plugin {
     }
 
     // <GET> ../				Get all Memory Measurments
-    // <GET> ../<Callsign>		Get the Memory Measurements for Callsign
+    // <GET> ../<Callsign>		Get the Memory Measurements for Callsign, 404 Not Found if it is not monitored
+    // <GET> ../<Callsign>,<Callsign>	Get the Memory Measurements for these Callsigns
+    // <GET> ..?fields=resident.last,operational	Only these fields, with any of the above
+    // <GET> ..?since=<generation>	304 Not Modified if none of them changed after that generation, with any of the above
     // <PUT> ../<Callsign>		Reset the Memory measurements for Callsign
+    // <POST> ../				Set the restart limits and/or the limits and intervals of the observable in the body
     /* virtual */ Core::ProxyType<Web::Response> Monitor::Process(const Web::Request& request)
     {
         ASSERT(_skipURL <= request.Path.length());
 
+        const uint64_t start = Clock::Now();
+
         Core::ProxyType<Web::Response> result(PluginHost::IFactories::Instance().Response());
         Core::TextSegmentIterator index(Core::TextFragment(request.Path, _skipURL, static_cast<uint32_t>(request.Path.length() - _skipURL)), false, '/');
 
@@ -104,24 +108,42 @@ namespace Plugin {
         result->Message = "OK";
 
         if (request.Verb == Web::Request::HTTP_GET) {
-            // Let's list them all....
-            if (index.Next() == false) {
+            std::vector<string> callsigns;
+            Projection projection;
+
+            if (index.Next() == true) {
+                callsigns = Projection::Split(index.Current().Text(), ',');
+            }
+
+            if ((request.Query.IsSet() == true) && (projection.Query(request.Query.Value()) == false)) {
+                result->ErrorCode = Web::STATUS_BAD_REQUEST;
+                result->Message = _T(" unknown field requested.");
+            } else if ((callsigns.size() == 1) && (_monitor.IsMonitored(callsigns.front()) == false)) {
+                // Before the generation, which is 0 for a callsign that is not known and would pass for unchanged.
+                result->ErrorCode = Web::STATUS_NOT_FOUND;
+                result->Message = _T(" is not monitored.");
+            } else if ((projection.Since() != 0) && (_monitor.Generation(callsigns) <= projection.Since())) {
+                result->ErrorCode = Web::STATUS_NOT_MODIFIED;
+                result->Message = _T("Not Modified");
+            } else if (callsigns.size() != 1) {
+                // Let's list them all, or the ones asked for....
                 if (_monitor.Length() > 0) {
                     Core::ProxyType<Web::JSONBodyType<Core::JSON::ArrayType<Monitor::Data>>> response(jsonBodyDataFactory.Element());
 
-                    _monitor.Snapshot(*response);
+                    _monitor.Snapshot(*response, callsigns, projection);
 
                     result->Body(Core::ProxyType<Web::IBody>(response));
                 }
             } else {
                 MetaData memoryInfo;
                 bool operational = false;
+                uint64_t generation = 0;
 
                 // Seems we only want 1 name
-                if (_monitor.Snapshot(index.Current().Text(), memoryInfo, operational) == true) {
+                if (_monitor.Snapshot(callsigns.front(), projection, memoryInfo, operational, generation) == true) {
                     Core::ProxyType<Web::JSONBodyType<Monitor::Data::MetaData>> response(jsonMemoryBodyDataFactory.Element());
 
-                    *response = Monitor::Data::MetaData(memoryInfo, operational);
+                    *response = Monitor::Data::MetaData(memoryInfo, operational, projection, generation);
 
                     result->Body(Core::ProxyType<Web::IBody>(response));
                 }
@@ -146,20 +168,36 @@ namespace Plugin {
             Core::ProxyType<const Monitor::Data> body(request.Body<const Monitor::Data>());
             string observable = body->Observable.Value();
 
-            uint16_t restartWindow = 0;
-            uint8_t restartLimit = 0;
+            if ((body->Restart.IsSet()) || (body->Limits.IsSet() == false)) {
+                uint16_t restartWindow = 0;
+                uint8_t restartLimit = 0;
 
-            if (body->Restart.IsSet()) {
-                restartWindow = body->Restart.Window;
-                restartLimit = body->Restart.Limit;
+                if (body->Restart.IsSet()) {
+                    restartWindow = body->Restart.Window;
+                    restartLimit = body->Restart.Limit;
+                }
+                TRACE(Trace::Information, (_T("Sets Restart Limits:[LIMIT:%d, WINDOW:%d]"), restartLimit, restartWindow));
+                _monitor.Update(observable, restartWindow, restartLimit);
+            }
+            if (body->Limits.IsSet()) {
+                LimitsInfo limits;
+                const uint32_t error = _monitor.Limits(observable, body->Limits, limits);
+
+                if (error == Core::ERROR_UNKNOWN_KEY) {
+                    result->ErrorCode = Web::STATUS_NOT_FOUND;
+                    result->Message = _T(" is not monitored.");
+                } else if (error != Core::ERROR_NONE) {
+                    result->ErrorCode = Web::STATUS_BAD_REQUEST;
+                    result->Message = _T(" could not set these limits.");
+                }
             }
-            TRACE(Trace::Information, (_T("Sets Restart Limits:[LIMIT:%d, WINDOW:%d]"), restartLimit, restartWindow));
-            _monitor.Update(observable, restartWindow, restartLimit);
         } else {
             result->ErrorCode = Web::STATUS_BAD_REQUEST;
             result->Message = _T(" could not handle your request.");
         }
 
+        _monitor.Handled(Clock::Now() - start);
+
         return (result);
     }
 }
@@ -22,18 +22,21 @@
 #define __MONITOR_H
 
 #include "Module.h"
-#include <interfaces/IMemory.h>
+#include "CGroup.h"
+#include "Clock.h"
+#include "Diagnostics.h"
+#include "MonitorObject.h"
+#include "Processes.h"
+#include "Prober.h"
+#include "Projection.h"
+#include "Recorder.h"
+#include "Rules.h"
+#include "Statistics.h"
+#include "Telemetry.h"
 #include <interfaces/json/JsonData_Monitor.h>
-#include <limits>
+#include <fstream>
 #include <string>
 
-#include <telemetry_busmessage_sender.h>
-
-static uint32_t gcd(uint32_t a, uint32_t b)
-{
-    return b == 0 ? a : gcd(b, a % b);
-}
-
 namespace WPEFramework {
 namespace Plugin {
 
@@ -65,140 +68,155 @@ namespace Plugin {
             Core::JSON::DecUInt8 Limit;
         };
 
-    public:
-        class MetaData {
+        // What can be tuned on a running observable, in the units of the configuration.
+        class LimitsInfo : public Core::JSON::Container {
         public:
-            MetaData()
-                : _resident()
-                , _allocated()
-                , _shared()
-                , _process()
-            {
-            }
-            MetaData(const MetaData& copy)
-                : _resident(copy._resident)
-                , _allocated(copy._allocated)
-                , _shared(copy._shared)
-                , _process(copy._process)
-            {
-            }
-            ~MetaData()
-            {
-            }
+            LimitsInfo& operator=(const LimitsInfo&) = delete;
 
-            MetaData& operator= (const MetaData& rhs)
+            LimitsInfo()
+                : Core::JSON::Container()
             {
-                _resident = rhs._resident;
-                _allocated = rhs._allocated;
-                _shared = rhs._shared;
-                _process = rhs._process;
-
-                return (*this);
-            }
- 
-        public:
-            bool HasMeasurements() const {
-                return ((_resident.Measurements() != 0) || (_allocated.Measurements() != 0) || (_shared.Measurements() != 0) || (_process.Measurements() != 0));
+                Add(_T("memory"), &MetaData);
+                Add(_T("memorylimit"), &MetaDataLimit);
+                Add(_T("memorysoftlimit"), &MetaDataSoftLimit);
+                Add(_T("operational"), &Operational);
             }
-
-            void AddMeasurements(const uint64_t resident, const uint64_t allocated, const uint64_t shared, const uint64_t process) {
-                _resident.Set(resident);
-                _allocated.Set(allocated);
-                _shared.Set(shared);
-                _process.Set(process);
-            }
-
-            void Measure(Exchange::IMemory* memInterface)
+            LimitsInfo(const LimitsInfo& copy)
+                : Core::JSON::Container()
+                , MetaData(copy.MetaData)
+                , MetaDataLimit(copy.MetaDataLimit)
+                , MetaDataSoftLimit(copy.MetaDataSoftLimit)
+                , Operational(copy.Operational)
             {
-                _resident.Set(memInterface->Resident());
-                _allocated.Set(memInterface->Allocated());
-                _shared.Set(memInterface->Shared());
-                _process.Set(memInterface->Processes());
+                Add(_T("memory"), &MetaData);
+                Add(_T("memorylimit"), &MetaDataLimit);
+                Add(_T("memorysoftlimit"), &MetaDataSoftLimit);
+                Add(_T("operational"), &Operational);
             }
-            void Reset()
+            virtual ~LimitsInfo()
             {
-                _resident.Reset();
-                _allocated.Reset();
-                _shared.Reset();
-                _process.Reset();
             }
 
-        public:
-            inline const Core::MeasurementType<uint64_t>& Resident() const
-            {
-                return (_resident);
-            }
-            inline const Core::MeasurementType<uint64_t>& Allocated() const
-            {
-                return (_allocated);
-            }
-            inline const Core::MeasurementType<uint64_t>& Shared() const
-            {
-                return (_shared);
-            }
-            inline const Core::MeasurementType<uint8_t>& Process() const
-            {
-                return (_process);
-            }
-        private:
-            Core::MeasurementType<uint64_t> _resident;
-            Core::MeasurementType<uint64_t> _allocated;
-            Core::MeasurementType<uint64_t> _shared;
-            Core::MeasurementType<uint8_t> _process;
+            Core::JSON::DecUInt32 MetaData; //!< Seconds between memory samples.
+            Core::JSON::DecUInt32 MetaDataLimit; //!< KiB resident.
+            Core::JSON::DecUInt32 MetaDataSoftLimit; //!< KiB resident.
+            Core::JSON::DecSInt32 Operational; //!< Seconds between operational checks, negative to only observe.
         };
 
+    public:
+        // What is measured of an observable.
+        using MetaData = MonitorObject::MetaData;
+
         class Data : public Core::JSON::Container {
         public:
             class MetaData : public Core::JSON::Container {
             public:
-                class Measurement : public Core::JSON::Container {
+                class WindowInfo : public Core::JSON::Container {
                 public:
-                    Measurement()
+                    WindowInfo()
                         : Core::JSON::Container()
                     {
                         Add(_T("min"), &Min);
                         Add(_T("max"), &Max);
                         Add(_T("average"), &Average);
-                        Add(_T("last"), &Last);
+                        Add(_T("count"), &Count);
                     }
-                    Measurement(const uint64_t min, const uint64_t max, const uint64_t average, const uint64_t last)
+                    WindowInfo(const WindowInfo& copy)
                         : Core::JSON::Container()
+                        , Min(copy.Min)
+                        , Max(copy.Max)
+                        , Average(copy.Average)
+                        , Count(copy.Count)
                     {
                         Add(_T("min"), &Min);
                         Add(_T("max"), &Max);
                         Add(_T("average"), &Average);
-                        Add(_T("last"), &Last);
+                        Add(_T("count"), &Count);
+                    }
+                    ~WindowInfo()
+                    {
+                    }
+
+                public:
+                    WindowInfo& operator=(const WindowInfo& RHS)
+                    {
+                        Min = RHS.Min;
+                        Max = RHS.Max;
+                        Average = RHS.Average;
+                        Count = RHS.Count;
 
-                        Min = min;
-                        Max = max;
-                        Average = average;
-                        Last = last;
+                        return (*this);
                     }
-                    Measurement(const Core::MeasurementType<uint64_t>& input)
-                        : Core::JSON::Container()
+                    WindowInfo& operator=(const Window::Aggregate& RHS)
                     {
-                        Add(_T("min"), &Min);
-                        Add(_T("max"), &Max);
-                        Add(_T("average"), &Average);
-                        Add(_T("last"), &Last);
+                        if (RHS.Count != 0) {
+                            Min = RHS.Min;
+                            Max = RHS.Max;
+                            Average = RHS.Average;
+                        }
+                        Count = RHS.Count;
 
-                        Min = input.Min();
-                        Max = input.Max();
-                        Average = input.Average();
-                        Last = input.Last();
+                        return (*this);
                     }
-                    Measurement(const Core::MeasurementType<uint8_t>& input)
+
+                public:
+                    Core::JSON::DecUInt64 Min;
+                    Core::JSON::DecUInt64 Max;
+                    Core::JSON::DecUInt64 Average;
+                    Core::JSON::DecUInt32 Count;
+                };
+
+                class RecentInfo : public Core::JSON::Container {
+                public:
+                    RecentInfo()
                         : Core::JSON::Container()
                     {
-                        Add(_T("min"), &Min);
-                        Add(_T("max"), &Max);
-                        Add(_T("average"), &Average);
-                        Add(_T("last"), &Last);
+                        Add(_T("1m"), &Minute);
+                        Add(_T("5m"), &FiveMinutes);
+                        Add(_T("1h"), &Hour);
+                    }
+                    RecentInfo(const RecentInfo& copy)
+                        : Core::JSON::Container()
+                        , Minute(copy.Minute)
+                        , FiveMinutes(copy.FiveMinutes)
+                        , Hour(copy.Hour)
+                    {
+                        Add(_T("1m"), &Minute);
+                        Add(_T("5m"), &FiveMinutes);
+                        Add(_T("1h"), &Hour);
+                    }
+                    ~RecentInfo()
+                    {
+                    }
+
+                public:
+                    RecentInfo& operator=(const RecentInfo& RHS)
+                    {
+                        Minute = RHS.Minute;
+                        FiveMinutes = RHS.FiveMinutes;
+                        Hour = RHS.Hour;
 
-                        Min = input.Min();
-                        Max = input.Max();
-                        Average = input.Average();
-                        Last = input.Last();
+                        return (*this);
+                    }
+                    void Set(const Windows& windows, const uint64_t now)
+                    {
+                        Minute = windows.Get(Windows::MINUTE, now);
+                        FiveMinutes = windows.Get(Windows::FIVE_MINUTES, now);
+                        Hour = windows.Get(Windows::HOUR, now);
+                    }
+
+                public:
+                    WindowInfo Minute;
+                    WindowInfo FiveMinutes;
+                    WindowInfo Hour;
+                };
+
+                class Measurement : public Core::JSON::Container {
+                public:
+                    Measurement()
+                        : Core::JSON::Container()
+                    {
+                        Register();
                     }
                     Measurement(const Measurement& copy)
                         : Core::JSON::Container()
@@ -206,11 +224,12 @@ namespace Plugin {
                         , Max(copy.Max)
                         , Average(copy.Average)
                         , Last(copy.Last)
+                        , P50(copy.P50)
+                        , P95(copy.P95)
+                        , P99(copy.P99)
+                        , Recent(copy.Recent)
                     {
-                        Add(_T("min"), &Min);
-                        Add(_T("max"), &Max);
-                        Add(_T("average"), &Average);
-                        Add(_T("last"), &Last);
+                        Register();
                     }
                     ~Measurement()
                     {
@@ -223,6 +242,10 @@ namespace Plugin {
                         Max = RHS.Max;
                         Average = RHS.Average;
                         Last = RHS.Last;
+                        P50 = RHS.P50;
+                        P95 = RHS.P95;
+                        P99 = RHS.P99;
+                        Recent = RHS.Recent;
 
                         return (*this);
                     }
@@ -234,6 +257,10 @@ namespace Plugin {
                             Max = std::move(RHS.Max);
                             Average = std::move(RHS.Average);
                             Last = std::move(RHS.Last);
+                            P50 = std::move(RHS.P50);
+                            P95 = std::move(RHS.P95);
+                            P99 = std::move(RHS.P99);
+                            Recent = RHS.Recent;
                         }
                         return (*this);
                     }
@@ -246,63 +273,149 @@ namespace Plugin {
 
                         return (*this);
                     }
+                    // Only the statistics asked for (Projection::statistic) are filled in, the rest stays out of the JSON.
+                    void Set(const Core::MeasurementType<uint64_t>& input, const Histogram* distribution, const Windows* recent, const uint64_t now, const uint8_t statistics)
+                    {
+                        if ((statistics & Projection::MIN) != 0) {
+                            Min = input.Min();
+                        }
+                        if ((statistics & Projection::MAX) != 0) {
+                            Max = input.Max();
+                        }
+                        if ((statistics & Projection::AVERAGE) != 0) {
+                            Average = input.Average();
+                        }
+                        if ((statistics & Projection::LAST) != 0) {
+                            Last = input.Last();
+                        }
+                        if ((distribution != nullptr) && (distribution->Measurements() != 0)) {
+                            if ((statistics & Projection::P50) != 0) {
+                                P50 = distribution->Quantile(0.50);
+                            }
+                            if ((statistics & Projection::P95) != 0) {
+                                P95 = distribution->Quantile(0.95);
+                            }
+                            if ((statistics & Projection::P99) != 0) {
+                                P99 = distribution->Quantile(0.99);
+                            }
+                        }
+                        if ((recent != nullptr) && ((statistics & Projection::RECENT) != 0)) {
+                            Recent.Set(*recent, now);
+                        }
+                    }
+
+                private:
+                    void Register()
+                    {
+                        Add(_T("min"), &Min);
+                        Add(_T("max"), &Max);
+                        Add(_T("average"), &Average);
+                        Add(_T("last"), &Last);
+                        Add(_T("p50"), &P50);
+                        Add(_T("p95"), &P95);
+                        Add(_T("p99"), &P99);
+                        Add(_T("recent"), &Recent);
+                    }
 
                 public:
                     Core::JSON::DecUInt64 Min;
                     Core::JSON::DecUInt64 Max;
                     Core::JSON::DecUInt64 Average;
                     Core::JSON::DecUInt64 Last;
+                    Core::JSON::DecUInt64 P50;
+                    Core::JSON::DecUInt64 P95;
+                    Core::JSON::DecUInt64 P99;
+                    RecentInfo Recent;
+                };
+
+                class ProcessInfo : public Core::JSON::Container {
+                public:
+                    ProcessInfo()
+                        : Core::JSON::Container()
+                    {
+                        Add(_T("pid"), &Pid);
+                        Add(_T("name"), &Name);
+                        Add(_T("resident"), &Resident);
+                        Add(_T("pss"), &Proportional);
+                    }
+                    ProcessInfo(const ProcessInfo& copy)
+                        : Core::JSON::Container()
+                        , Pid(copy.Pid)
+                        , Name(copy.Name)
+                        , Resident(copy.Resident)
+                        , Proportional(copy.Proportional)
+                    {
+                        Add(_T("pid"), &Pid);
+                        Add(_T("name"), &Name);
+                        Add(_T("resident"), &Resident);
+                        Add(_T("pss"), &Proportional);
+                    }
+                    ~ProcessInfo()
+                    {
+                    }
+
+                public:
+                    ProcessInfo& operator=(const ProcessInfo& RHS)
+                    {
+                        Pid = RHS.Pid;
+                        Name = RHS.Name;
+                        Resident = RHS.Resident;
+                        Proportional = RHS.Proportional;
+
+                        return (*this);
+                    }
+                    ProcessInfo& operator=(const Monitor::MetaData::Child& RHS)
+                    {
+                        Pid = RHS.Pid;
+                        Name = RHS.Name;
+                        Resident = RHS.Resident;
+                        Proportional = RHS.Proportional;
+
+                        return (*this);
+                    }
+
+                public:
+                    Core::JSON::DecUInt32 Pid;
+                    Core::JSON::String Name;
+                    Measurement Resident;
+                    Measurement Proportional; //!< PSS, the share of the pages it has in common with other processes included.
                 };
 
             public:
                 MetaData()
                     : Core::JSON::Container()
-                    , Allocated()
-                    , Resident()
-                    , Shared()
-                    , Process()
+                    , Metric()
                     , Operational()
                     , Count()
+                    , Processes()
+                    , Generation()
                 {
-                    Add(_T("allocated"), &Allocated);
-                    Add(_T("resident"), &Resident);
-                    Add(_T("shared"), &Shared);
-                    Add(_T("process"), &Process);
-                    Add(_T("operational"), &Operational);
-                    Add(_T("count"), &Count);
+                    Register();
                 }
-                MetaData(const Monitor::MetaData& input, const bool operational)
+                MetaData(const Monitor::MetaData& input, const bool operational, const Projection& projection = Projection(), const uint64_t generation = 0)
                     : Core::JSON::Container()
+                    , Metric()
+                    , Operational()
+                    , Count()
+                    , Processes()
+                    , Generation()
                 {
-                    Add(_T("allocated"), &Allocated);
-                    Add(_T("resident"), &Resident);
-                    Add(_T("shared"), &Shared);
-                    Add(_T("process"), &Process);
-                    Add(_T("operational"), &Operational);
-                    Add(_T("count"), &Count);
-
-                    Allocated = input.Allocated();
-                    Resident = input.Resident();
-                    Shared = input.Shared();
-                    Process = input.Process();
-                    Operational = operational;
-                    Count = input.Allocated().Measurements();
+                    Register();
+                    Set(input, operational, projection, Projection::STATISTICS, generation);
                 }
                 MetaData(const MetaData& copy)
                     : Core::JSON::Container()
-                    , Allocated(copy.Allocated)
-                    , Resident(copy.Resident)
-                    , Shared(copy.Shared)
-                    , Process(copy.Process)
+                    , Metric()
                     , Operational(copy.Operational)
                     , Count(copy.Count)
+                    , Processes(copy.Processes)
+                    , Generation(copy.Generation)
                 {
-                    Add(_T("allocated"), &Allocated);
-                    Add(_T("resident"), &Resident);
-                    Add(_T("shared"), &Shared);
-                    Add(_T("process"), &Process);
-                    Add(_T("operational"), &Operational);
-                    Add(_T("count"), &Count);
+                    Register();
+
+                    for (uint8_t index = 0; index < Metrics::METRICS; index++) {
+                        Metric[index] = copy.Metric[index];
+                    }
                 }
                 ~MetaData()
                 {
@@ -310,23 +423,70 @@ namespace Plugin {
 
                 MetaData& operator=(const MetaData& RHS)
                 {
-                    Allocated = RHS.Allocated;
-                    Resident = RHS.Resident;
-                    Shared = RHS.Shared;
-                    Process = RHS.Process;
+                    for (uint8_t index = 0; index < Metrics::METRICS; index++) {
+                        Metric[index] = RHS.Metric[index];
+                    }
                     Operational = RHS.Operational;
                     Count = RHS.Count;
+                    Processes = RHS.Processes;
+                    Generation = RHS.Generation;
 
                     return (*this);
                 }
 
+                // Lifetime statistics only if they are in statistics, the rolling windows have their own.
+                // A generation of 0 is left out.
+                void Set(const Monitor::MetaData& input, const bool operational, const Projection& projection, const uint8_t statistics, const uint64_t generation)
+                {
+                    const uint64_t now = Clock::Now();
+                    const uint8_t selected = (statistics | Projection::RECENT);
+
+                    for (uint8_t index = 0; index < Metrics::METRICS; index++) {
+                        const Metrics::metric which = static_cast<Metrics::metric>(index);
+
+                        if (((Metrics::Describe(which).Keep & Metrics::SPARSE) == 0) || (input.Lifetime(which).Measurements() != 0)) {
+                            Metric[index].Set(input.Lifetime(which), input.Distribution(which), input.Recent(which), now, projection.Statistics(which) & selected);
+                        }
+                    }
+                    if (projection.Has(Projection::OPERATIONAL) == true) {
+                        Operational = operational;
+                    }
+                    if (projection.Has(Projection::COUNT) == true) {
+                        Count = input.Lifetime(Metrics::ALLOCATED).Measurements();
+                    }
+                    if (projection.Has(Projection::PROCESSES) == true) {
+                        Breakdown(input.Children());
+                    }
+                    if (generation != 0) {
+                        Generation = generation;
+                    }
+                }
+                void Breakdown(const std::vector<Monitor::MetaData::Child>& children)
+                {
+                    for (const Monitor::MetaData::Child& child : children) {
+                        Processes.Add() = child;
+                    }
+                }
+
+            private:
+                // The metrics under the names of the table, in its order.
+                void Register()
+                {
+                    for (uint8_t index = 0; index < Metrics::METRICS; index++) {
+                        Add(Metrics::Describe(static_cast<Metrics::metric>(index)).Name, &Metric[index]);
+                    }
+                    Add(_T("operational"), &Operational);
+                    Add(_T("count"), &Count);
+                    Add(_T("processes"), &Processes);
+                    Add(_T("generation"), &Generation);
+                }
+
             public:
-                Measurement Allocated;
-                Measurement Resident;
-                Measurement Shared;
-                Measurement Process;
+                Measurement Metric[Metrics::METRICS]; //!< By Metrics::metric.
                 Core::JSON::Boolean Operational;
                 Core::JSON::DecUInt32 Count;
+                Core::JSON::ArrayType<ProcessInfo> Processes; //!< Only for observables with a breakdown configured.
+                Core::JSON::DecUInt64 Generation; //!< Of the latest change, to ask for what changed since.
             };
 
         private:
@@ -339,23 +499,27 @@ namespace Plugin {
                 , Measurement()
                 , Observable()
                 , Restart()
+                , Limits()
             {
                 Add(_T("name"), &Name);
                 Add(_T("measurment"), &Measurement);
                 Add(_T("observable"), &Observable);
                 Add(_T("restart"), &Restart);
+                Add(_T("limits"), &Limits);
             }
-            Data(const string& name, const Monitor::MetaData& info, const bool operational)
+            Data(const string& name, const Monitor::MetaData& info, const bool operational, const Projection& projection = Projection(), const uint64_t generation = 0)
                 : Core::JSON::Container()
                 , Name()
-                , Measurement(info, operational)
+                , Measurement(info, operational, projection, generation)
                 , Observable()
                 , Restart()
+                , Limits()
             {
                 Add(_T("name"), &Name);
                 Add(_T("measurment"), &Measurement);
                 Add(_T("observable"), &Observable);
                 Add(_T("restart"), &Restart);
+                Add(_T("limits"), &Limits);
 
                 Name = name;
             }
@@ -365,33 +529,489 @@ namespace Plugin {
                 , Measurement(copy.Measurement)
                 , Observable(copy.Observable)
                 , Restart(copy.Restart)
+                , Limits(copy.Limits)
             {
                 Add(_T("name"), &Name);
                 Add(_T("measurment"), &Measurement);
                 Add(_T("observable"), &Observable);
                 Add(_T("restart"), &Restart);
+                Add(_T("limits"), &Limits);
             }
             ~Data()
             {
             }
 
-        public:
-            Core::JSON::String Name;
-            MetaData Measurement;
-            Core::JSON::String Observable;
-            RestartInfo Restart;
-        };
+        public:
+            Core::JSON::String Name;
+            MetaData Measurement;
+            Core::JSON::String Observable;
+            RestartInfo Restart;
+            LimitsInfo Limits;
+        };
+
+        // JSON-RPC counterpart of Data, the layout of the generated InfoInfo
+        // extended with the statistics the generated interface does not carry.
+        // This and the payloads of the methods and events added in 1.2.0 below
+        // are laid out as doc/MonitorPlugin.md defines them, they give way to the
+        // generated types once the interface definition carries them.
+        class Info : public Core::JSON::Container {
+        public:
+            Info()
+                : Core::JSON::Container()
+                , Measurements()
+                , Observable()
+                , Restart()
+            {
+                Add(_T("measurements"), &Measurements);
+                Add(_T("observable"), &Observable);
+                Add(_T("restart"), &Restart);
+            }
+            Info(const Info& copy)
+                : Core::JSON::Container()
+                , Measurements(copy.Measurements)
+                , Observable(copy.Observable)
+                , Restart(copy.Restart)
+            {
+                Add(_T("measurements"), &Measurements);
+                Add(_T("observable"), &Observable);
+                Add(_T("restart"), &Restart);
+            }
+            ~Info()
+            {
+            }
+
+            Info& operator=(const Info& RHS)
+            {
+                Measurements = RHS.Measurements;
+                Observable = RHS.Observable;
+                Restart.Window = RHS.Restart.Window;
+                Restart.Limit = RHS.Restart.Limit;
+
+                return (*this);
+            }
+
+        public:
+            Data::MetaData Measurements;
+            Core::JSON::String Observable;
+            RestartInfo Restart;
+        };
+
+        // Payload of the memorypressure event, sizes in KiB.
+        class PressureInfo : public Core::JSON::Container {
+        private:
+            PressureInfo(const PressureInfo&) = delete;
+            PressureInfo& operator=(const PressureInfo&) = delete;
+
+        public:
+            PressureInfo()
+                : Core::JSON::Container()
+                , Callsign()
+                , Resident()
+                , Limit()
+            {
+                Add(_T("callsign"), &Callsign);
+                Add(_T("resident"), &Resident);
+                Add(_T("limit"), &Limit);
+            }
+            ~PressureInfo()
+            {
+            }
+
+        public:
+            Core::JSON::String Callsign;
+            Core::JSON::DecUInt64 Resident;
+            Core::JSON::DecUInt64 Limit;
+        };
+
+        // Parameters of setlimits, only the limits that are set change.
+        class LimitsParamsInfo : public Core::JSON::Container {
+        private:
+            LimitsParamsInfo(const LimitsParamsInfo&) = delete;
+            LimitsParamsInfo& operator=(const LimitsParamsInfo&) = delete;
+
+        public:
+            LimitsParamsInfo()
+                : Core::JSON::Container()
+                , Callsign()
+                , Limits()
+            {
+                Add(_T("callsign"), &Callsign);
+                Add(_T("limits"), &Limits);
+            }
+            ~LimitsParamsInfo()
+            {
+            }
+
+        public:
+            Core::JSON::String Callsign;
+            LimitsInfo Limits;
+        };
+
+        // Result of reloadconfig, the callsigns per kind of change.
+        class ReloadInfo : public Core::JSON::Container {
+        private:
+            ReloadInfo(const ReloadInfo&) = delete;
+            ReloadInfo& operator=(const ReloadInfo&) = delete;
+
+        public:
+            ReloadInfo()
+                : Core::JSON::Container()
+                , Added()
+                , Updated()
+                , Removed()
+            {
+                Add(_T("added"), &Added);
+                Add(_T("updated"), &Updated);
+                Add(_T("removed"), &Removed);
+            }
+            ~ReloadInfo()
+            {
+            }
+
+        public:
+            Core::JSON::ArrayType<Core::JSON::String> Added;
+            Core::JSON::ArrayType<Core::JSON::String> Updated;
+            Core::JSON::ArrayType<Core::JSON::String> Removed;
+        };
+
+        // What the monitor itself costs, all durations in MicroSeconds.
+        class SelfInfo : public Core::JSON::Container {
+        public:
+            class LatencyInfo : public Core::JSON::Container {
+            public:
+                LatencyInfo()
+                    : Core::JSON::Container()
+                {
+                    Add(_T("count"), &Count);
+                    Add(_T("average"), &Average);
+                    Add(_T("max"), &Max);
+                    Add(_T("p50"), &P50);
+                    Add(_T("p95"), &P95);
+                    Add(_T("p99"), &P99);
+                }
+                LatencyInfo(const LatencyInfo& copy)
+                    : Core::JSON::Container()
+                    , Count(copy.Count)
+                    , Average(copy.Average)
+                    , Max(copy.Max)
+                    , P50(copy.P50)
+                    , P95(copy.P95)
+                    , P99(copy.P99)
+                {
+                    Add(_T("count"), &Count);
+                    Add(_T("average"), &Average);
+                    Add(_T("max"), &Max);
+                    Add(_T("p50"), &P50);
+                    Add(_T("p95"), &P95);
+                    Add(_T("p99"), &P99);
+                }
+                ~LatencyInfo()
+                {
+                }
+
+                LatencyInfo& operator=(const LatencyInfo& RHS)
+                {
+                    Count = RHS.Count;
+                    Average = RHS.Average;
+                    Max = RHS.Max;
+                    P50 = RHS.P50;
+                    P95 = RHS.P95;
+                    P99 = RHS.P99;
+
+                    return (*this);
+                }
+                LatencyInfo& operator=(const Latency& RHS)
+                {
+                    Count = RHS.Measurements();
+                    Average = RHS.Average();
+                    Max = RHS.Max();
+                    P50 = RHS.Quantile(0.50);
+                    P95 = RHS.Quantile(0.95);
+                    P99 = RHS.Quantile(0.99);
+
+                    return (*this);
+                }
+
+            public:
+                Core::JSON::DecUInt32 Count;
+                Core::JSON::DecUInt64 Average;
+                Core::JSON::DecUInt64 Max;
+                Core::JSON::DecUInt64 P50;
+                Core::JSON::DecUInt64 P95;
+                Core::JSON::DecUInt64 P99;
+            };
+
+            class ObservableInfo : public Core::JSON::Container {
+            public:
+                ObservableInfo()
+                    : Core::JSON::Container()
+                {
+                    Add(_T("callsign"), &Callsign);
+                    Add(_T("evaluate"), &Evaluate);
+                    Add(_T("ipc"), &IPC);
+                    Add(_T("interval"), &Interval);
+                }
+                ObservableInfo(const ObservableInfo& copy)
+                    : Core::JSON::Container()
+                    , Callsign(copy.Callsign)
+                    , Evaluate(copy.Evaluate)
+                    , IPC(copy.IPC)
+                    , Interval(copy.Interval)
+                {
+                    Add(_T("callsign"), &Callsign);
+                    Add(_T("evaluate"), &Evaluate);
+                    Add(_T("ipc"), &IPC);
+                    Add(_T("interval"), &Interval);
+                }
+                ~ObservableInfo()
+                {
+                }
+
+                ObservableInfo& operator=(const ObservableInfo& RHS)
+                {
+                    Callsign = RHS.Callsign;
+                    Evaluate = RHS.Evaluate;
+                    IPC = RHS.IPC;
+                    Interval = RHS.Interval;
+
+                    return (*this);
+                }
+
+            public:
+                Core::JSON::String Callsign;
+                LatencyInfo Evaluate;
+                Core::JSON::DecUInt32 IPC;
+                Core::JSON::DecUInt32 Interval; //!< Current memory sampling interval.
+            };
+
+        public:
+            SelfInfo(const SelfInfo&) = delete;
+            SelfInfo& operator=(const SelfInfo&) = delete;
+
+            SelfInfo()
+                : Core::JSON::Container()
+            {
+                Add(_T("dispatch"), &Dispatch);
+                Add(_T("lateness"), &Lateness);
+                Add(_T("requests"), &Requests);
+                Add(_T("notifications"), &Notifications);
+                Add(_T("activation"), &Activation);
+                Add(_T("enforcement"), &Enforcement);
+                Add(_T("startup"), &Startup);
+                Add(_T("ipc"), &IPC);
+                Add(_T("observables"), &Observables);
+            }
+            ~SelfInfo()
+            {
+            }
+
+        public:
+            LatencyInfo Dispatch; //!< Run time of one scheduler pass.
+            LatencyInfo Lateness; //!< Actual minus intended evaluation time.
+            LatencyInfo Requests; //!< Handling time of JSON-RPC and REST requests.
+            LatencyInfo Notifications; //!< Time spent in the plugin lifecycle callbacks.
+            LatencyInfo Activation; //!< Activation of an observable till the first probe that reached it.
+            LatencyInfo Enforcement; //!< Violation detected till the deactivation was submitted.
+            Core::JSON::DecUInt64 Startup; //!< Time it took to set up the monitoring of all observables.
+            Core::JSON::DecUInt32 IPC; //!< Calls made into observed plugins.
+            Core::JSON::ArrayType<ObservableInfo> Observables;
+        };
+
+        // What the flight recorder holds, oldest record first.
+        class RecorderInfo : public Core::JSON::Container {
+        public:
+            class RecordInfo : public Core::JSON::Container {
+            public:
+                RecordInfo()
+                    : Core::JSON::Container()
+                {
+                    Add(_T("time"), &Time);
+                    Add(_T("callsign"), &Callsign);
+                    Add(_T("event"), &Event);
+                    Add(_T("reason"), &Reason);
+                    Add(_T("value"), &Value);
+                    Add(_T("limit"), &Limit);
+                    Add(_T("status"), &Status);
+                }
+                RecordInfo(const RecordInfo& copy)
+                    : Core::JSON::Container()
+                    , Time(copy.Time)
+                    , Callsign(copy.Callsign)
+                    , Event(copy.Event)
+                    , Reason(copy.Reason)
+                    , Value(copy.Value)
+                    , Limit(copy.Limit)
+                    , Status(copy.Status)
+                {
+                    Add(_T("time"), &Time);
+                    Add(_T("callsign"), &Callsign);
+                    Add(_T("event"), &Event);
+                    Add(_T("reason"), &Reason);
+                    Add(_T("value"), &Value);
+                    Add(_T("limit"), &Limit);
+                    Add(_T("status"), &Status);
+                }
+                ~RecordInfo()
+                {
+                }
+
+                RecordInfo& operator=(const RecordInfo& RHS)
+                {
+                    Time = RHS.Time;
+                    Callsign = RHS.Callsign;
+                    Event = RHS.Event;
+                    Reason = RHS.Reason;
+                    Value = RHS.Value;
+                    Limit = RHS.Limit;
+                    Status = RHS.Status;
+
+                    return (*this);
+                }
+
+            public:
+                Core::JSON::DecUInt64 Time; //!< MicroSeconds since the epoch.
+                Core::JSON::String Callsign;
+                Core::JSON::String Event; //!< Sample, Pressure, Deactivate, Restart, GiveUp or Kill.
+                Core::JSON::String Reason; //!< Why it was deactivated, only for Deactivate.
+                Core::JSON::DecUInt64 Value; //!< See Recorder::kind.
+                Core::JSON::DecUInt64 Limit;
+                Core::JSON::HexUInt32 Status; //!< MonitorObject::evaluation bits.
+            };
+
+        public:
+            RecorderInfo(const RecorderInfo&) = delete;
+            RecorderInfo& operator=(const RecorderInfo&) = delete;
+
+            RecorderInfo()
+                : Core::JSON::Container()
+            {
+                Add(_T("capacity"), &Capacity);
+                Add(_T("written"), &Written);
+                Add(_T("lost"), &Lost);
+                Add(_T("records"), &Records);
+            }
+            ~RecorderInfo()
+            {
+            }
+
+        public:
+            Core::JSON::DecUInt32 Capacity;
+            Core::JSON::DecUInt64 Written; //!< Records written since the Monitor started.
+            Core::JSON::DecUInt64 Lost; //!< Overwritten, or being written, when the records were read.
+            Core::JSON::ArrayType<RecordInfo> Records;
+        };
+
+    private:
+        Monitor(const Monitor&);
+        Monitor& operator=(const Monitor&);
+
+        class Config : public Core::JSON::Container {
+        private:
+            Config(const Config&);
+            Config& operator=(const Config&);
+
+        public:
+            class Bounds : public Core::JSON::Container {
+            private:
+                Bounds& operator=(const Bounds&);
+
+            public:
+                Bounds()
+                    : Core::JSON::Container()
+                {
+                    Add(_T("min"), &Min);
+                    Add(_T("max"), &Max);
+                }
+                Bounds(const Bounds& copy)
+                    : Core::JSON::Container()
+                    , Min(copy.Min)
+                    , Max(copy.Max)
+                {
+                    Add(_T("min"), &Min);
+                    Add(_T("max"), &Max);
+                }
+                ~Bounds()
+                {
+                }
+
+            public:
+                Core::JSON::DecUInt32 Min;
+                Core::JSON::DecUInt32 Max;
+            };
+
+            class Filter : public Core::JSON::Container {
+            private:
+                Filter& operator=(const Filter&);
+
+            public:
+                Filter()
+                    : Core::JSON::Container()
+                    , Samples(1)
+                    , Window(1)
+                    , Sustain(0)
+                    , Hysteresis(0)
+                {
+                    Add(_T("samples"), &Samples);
+                    Add(_T("window"), &Window);
+                    Add(_T("sustain"), &Sustain);
+                    Add(_T("hysteresis"), &Hysteresis);
+                }
+                Filter(const Filter& copy)
+                    : Core::JSON::Container()
+                    , Samples(copy.Samples)
+                    , Window(copy.Window)
+                    , Sustain(copy.Sustain)
+                    , Hysteresis(copy.Hysteresis)
+                {
+                    Add(_T("samples"), &Samples);
+                    Add(_T("window"), &Window);
+                    Add(_T("sustain"), &Sustain);
+                    Add(_T("hysteresis"), &Hysteresis);
+                }
+                ~Filter()
+                {
+                }
+
+            public:
+                Core::JSON::DecUInt8 Samples; //!< Failing samples within the window needed to act.
+                Core::JSON::DecUInt8 Window; //!< Latest samples considered, at most 32.
+                Core::JSON::DecUInt32 Sustain; //!< Seconds the failing samples must go on uninterrupted.
+                Core::JSON::DecUInt8 Hysteresis; //!< Percent below a memory limit the resident size must drop before it counts as back below.
+            };
 
-    private:
-        Monitor(const Monitor&);
-        Monitor& operator=(const Monitor&);
+            class Role : public Core::JSON::Container {
+            private:
+                Role& operator=(const Role&);
 
-        class Config : public Core::JSON::Container {
-        private:
-            Config(const Config&);
-            Config& operator=(const Config&);
+            public:
+                Role()
+                    : Core::JSON::Container()
+                    , Scope(_T("plugin"))
+                {
+                    Add(_T("name"), &Name);
+                    Add(_T("memorylimit"), &MetaDataLimit);
+                    Add(_T("scope"), &Scope);
+                }
+                Role(const Role& copy)
+                    : Core::JSON::Container()
+                    , Name(copy.Name)
+                    , MetaDataLimit(copy.MetaDataLimit)
+                    , Scope(copy.Scope)
+                {
+                    Add(_T("name"), &Name);
+                    Add(_T("memorylimit"), &MetaDataLimit);
+                    Add(_T("scope"), &Scope);
+                }
+                ~Role()
+                {
+                }
+
+            public:
+                Core::JSON::String Name; //!< Process name, as in /proc/<pid>/status.
+                Core::JSON::DecUInt32 MetaDataLimit; //!< KiB resident for each process of this role.
+                Core::JSON::String Scope; //!< "plugin" shuts the observable down, "process" only kills the process over the limit.
+            };
 
-        public:
             class Entry : public Core::JSON::Container {
             private:
                 Entry& operator=(const Entry& RHS);
@@ -403,22 +1023,58 @@ namespace Plugin {
                     Add(_T("callsign"), &Callsign);
                     Add(_T("memory"), &MetaData);
                     Add(_T("memorylimit"), &MetaDataLimit);
+                    Add(_T("memorysoftlimit"), &MetaDataSoftLimit);
+                    Add(_T("memorygrace"), &MetaDataGrace);
                     Add(_T("operational"), &Operational);
                     Add(_T("restart"), &Restart);
+                    Add(_T("failuremarker"), &FailureMarker);
+                    Add(_T("probetimeout"), &ProbeTimeout);
+                    Add(_T("filter"), &Rule);
+                    Add(_T("adaptive"), &Adaptive);
+                    Add(_T("suspended"), &Suspended);
+                    Add(_T("priority"), &Priority);
+                    Add(_T("breakdown"), &Breakdown);
+                    Add(_T("roles"), &Roles);
+                    Add(_T("dmabuf"), &Graphics);
+                    Add(_T("dmabuflimit"), &GraphicsLimit);
                 }
                 Entry(const Entry& copy)
                     : Core::JSON::Container()
                     , Callsign(copy.Callsign)
                     , MetaData(copy.MetaData)
                     , MetaDataLimit(copy.MetaDataLimit)
+                    , MetaDataSoftLimit(copy.MetaDataSoftLimit)
+                    , MetaDataGrace(copy.MetaDataGrace)
                     , Operational(copy.Operational)
                     , Restart(copy.Restart)
+                    , FailureMarker(copy.FailureMarker)
+                    , ProbeTimeout(copy.ProbeTimeout)
+                    , Rule(copy.Rule)
+                    , Adaptive(copy.Adaptive)
+                    , Suspended(copy.Suspended)
+                    , Priority(copy.Priority)
+                    , Breakdown(copy.Breakdown)
+                    , Roles(copy.Roles)
+                    , Graphics(copy.Graphics)
+                    , GraphicsLimit(copy.GraphicsLimit)
                 {
                     Add(_T("callsign"), &Callsign);
                     Add(_T("memory"), &MetaData);
                     Add(_T("memorylimit"), &MetaDataLimit);
+                    Add(_T("memorysoftlimit"), &MetaDataSoftLimit);
+                    Add(_T("memorygrace"), &MetaDataGrace);
                     Add(_T("operational"), &Operational);
                     Add(_T("restart"), &Restart);
+                    Add(_T("failuremarker"), &FailureMarker);
+                    Add(_T("probetimeout"), &ProbeTimeout);
+                    Add(_T("filter"), &Rule);
+                    Add(_T("adaptive"), &Adaptive);
+                    Add(_T("suspended"), &Suspended);
+                    Add(_T("priority"), &Priority);
+                    Add(_T("breakdown"), &Breakdown);
+                    Add(_T("roles"), &Roles);
+                    Add(_T("dmabuf"), &Graphics);
+                    Add(_T("dmabuflimit"), &GraphicsLimit);
                 }
                 ~Entry()
                 {
@@ -428,8 +1084,142 @@ namespace Plugin {
                 Core::JSON::String Callsign;
                 Core::JSON::DecUInt32 MetaData;
                 Core::JSON::DecUInt32 MetaDataLimit;
+                Core::JSON::DecUInt32 MetaDataSoftLimit; //!< KiB resident from where the observable is asked to give memory back.
+                Core::JSON::DecUInt32 MetaDataGrace; //!< Seconds above the soft limit before it is shut down, 0 on the next sample above it. Left out leaves that to the hard limit.
                 Core::JSON::DecSInt32 Operational;
                 RestartInfo Restart;
+                Core::JSON::String FailureMarker; //!< T2 counter bumped when the observable is shut down for a failure.
+                Core::JSON::DecUInt32 ProbeTimeout; //!< Seconds a probe may take before the observable counts as unresponsive, 0 probes inline.
+                Filter Rule; //!< When failing operational and memory samples lead to a shutdown.
+                Bounds Adaptive; //!< Seconds the memory interval may range over, following the resident size.
+                Core::JSON::DecUInt32 Suspended; //!< Seconds between memory samples while suspended, 0 stops probing.
+                Core::JSON::DecUInt8 Priority; //!< Observables with the lowest priority give way first when the budget is exceeded.
+                Core::JSON::Boolean Breakdown; //!< Measures every process of the observable on its own and reports them in the status.
+                Core::JSON::ArrayType<Role> Roles; //!< Limits per process name, implies the breakdown.
+                Core::JSON::Boolean Graphics; //!< Accounts for the dma-buf memory the processes of the observable hold.
+                Core::JSON::DecUInt32 GraphicsLimit; //!< KiB dma-buf, implies the accounting.
+            };
+
+            class Reporting : public Core::JSON::Container {
+            private:
+                Reporting(const Reporting&);
+                Reporting& operator=(const Reporting&);
+
+            public:
+                Reporting()
+                    : Core::JSON::Container()
+                    , Interval(60)
+                    , Summary(60 * 60)
+                {
+                    Add(_T("interval"), &Interval);
+                    Add(_T("summary"), &Summary);
+                    Add(_T("deactivate"), &Deactivate);
+                    Add(_T("restart"), &Restart);
+                    Add(_T("giveup"), &GiveUp);
+                    Add(_T("memory"), &Memory);
+                    Add(_T("pressure"), &Pressure);
+                }
+                ~Reporting()
+                {
+                }
+
+            public:
+                Core::JSON::DecUInt32 Interval; //!< Seconds between two batches sent to the telemetry bus, 0 sends right away.
+                Core::JSON::DecUInt32 Summary; //!< Seconds between two memory summaries, 0 disables them.
+                Core::JSON::String Deactivate;
+                Core::JSON::String Restart;
+                Core::JSON::String GiveUp;
+                Core::JSON::String Memory;
+                Core::JSON::String Pressure;
+            };
+
+            class Allocation : public Core::JSON::Container {
+            private:
+                Allocation(const Allocation&);
+                Allocation& operator=(const Allocation&);
+
+            public:
+                Allocation()
+                    : Core::JSON::Container()
+                    , Limit(0)
+                    , Policy(_T("priority"))
+                {
+                    Add(_T("limit"), &Limit);
+                    Add(_T("policy"), &Policy);
+                }
+                ~Allocation()
+                {
+                }
+
+            public:
+                Core::JSON::DecUInt32 Limit; //!< KiB resident all observables together may use, 0 for no budget.
+                Core::JSON::String Policy; //!< "priority" (lowest priority, then largest) or "largest".
+            };
+
+            class Confinement : public Core::JSON::Container {
+            private:
+                Confinement(const Confinement&);
+                Confinement& operator=(const Confinement&);
+
+            public:
+                Confinement()
+                    : Core::JSON::Container()
+                {
+                    Add(_T("root"), &Root);
+                }
+                ~Confinement()
+                {
+                }
+
+            public:
+                Core::JSON::String Root; //!< cgroup v2 directory holding a group per observable, unset leaves the processes where they are.
+            };
+
+            class Recording : public Core::JSON::Container {
+            private:
+                Recording(const Recording&);
+                Recording& operator=(const Recording&);
+
+            public:
+                Recording()
+                    : Core::JSON::Container()
+                    , Size(Recorder::DefaultCapacity)
+                {
+                    Add(_T("size"), &Size);
+                    Add(_T("dump"), &Dump);
+                }
+                ~Recording()
+                {
+                }
+
+            public:
+                Core::JSON::DecUInt32 Size; //!< Records kept, rounded up to a power of two.
+                Core::JSON::String Dump; //!< File the records are written to when a plugin is given up on, unset puts it in the volatile path.
+            };
+
+            class Evidence : public Core::JSON::Container {
+            private:
+                Evidence(const Evidence&);
+                Evidence& operator=(const Evidence&);
+
+            public:
+                Evidence()
+                    : Core::JSON::Container()
+                    , Budget(20)
+                    , Size(4096)
+                {
+                    Add(_T("directory"), &Directory);
+                    Add(_T("budget"), &Budget);
+                    Add(_T("size"), &Size);
+                }
+                ~Evidence()
+                {
+                }
+
+            public:
+                Core::JSON::String Directory; //!< Where the captures taken before a forced shutdown go, unset takes none.
+                Core::JSON::DecUInt32 Budget; //!< MilliSeconds a capture may spend reading, what is not read by then is left out.
+                Core::JSON::DecUInt32 Size; //!< KiB all captures together may take, the oldest are removed first.
             };
 
         public:
@@ -437,6 +1227,11 @@ namespace Plugin {
                 : Core::JSON::Container()
             {
                 Add(_T("observables"), &Observables);
+                Add(_T("telemetry"), &Telemetry);
+                Add(_T("budget"), &Budget);
+                Add(_T("cgroup"), &CGroups);
+                Add(_T("recorder"), &Records);
+                Add(_T("diagnostics"), &Diagnosis);
             }
             ~Config()
             {
@@ -444,227 +1239,157 @@ namespace Plugin {
 
         public:
             Core::JSON::ArrayType<Entry> Observables;
+            Reporting Telemetry;
+            Allocation Budget;
+            Confinement CGroups;
+            Recording Records;
+            Evidence Diagnosis;
         };
 
         class MonitorObjects : public PluginHost::IPlugin::INotification, public PluginHost::IPlugin::ILifeTime {
         public:
             using Job = Core::ThreadPool::JobType<MonitorObjects>;
 
-            class MonitorObject {
-            public:
-                MonitorObject() = delete;
-                MonitorObject& operator=(const MonitorObject&) = delete;
+            using MonitorObject = Plugin::MonitorObject;
 
-                enum evaluation {
-                    SUCCESFULL = 0x00,
-                    NOT_OPERATIONAL = 0x01,
-                    EXCEEDED_MEMORY = 0x02
-                };
+            using MonitorObjectContainer = std::unordered_map<string, MonitorObject>;
 
-                typedef struct {
-                    int32_t Limit;
-                    int32_t WindowSeconds;
-                } RestartSettings;
+            class Connections : public RPC::IRemoteConnection::INotification {
+            public:
+                Connections() = delete;
+                Connections(const Connections&) = delete;
+                Connections& operator=(const Connections&) = delete;
+
+                explicit Connections(MonitorObjects& parent)
+                    : _parent(parent)
+                {
+                }
+                ~Connections() override = default;
 
             public:
-                MonitorObject(
-                    const bool actOnOperational,
-                    const uint32_t operationalInterval,
-                    const uint32_t memoryInterval,
-                    const uint64_t memoryThreshold,
-                    const uint64_t absTime,
-                    const uint16_t restartWindow,
-                    const uint8_t restartLimit)
-                    : _operationalInterval(operationalInterval)
-                    , _memoryInterval(memoryInterval)
-                    , _memoryThreshold(memoryThreshold * 1024)
-                    , _operationalSlots(operationalInterval)
-                    , _memorySlots(memoryInterval)
-                    , _nextSlot(absTime)
-                    , _restartWindow(restartWindow)
-                    , _restartWindowStart()
-                    , _restartCount(0)
-                    , _restartLimit(restartLimit)
-                    , _measurement()
-                    , _operational(false)
-                    , _operationalEvaluate(actOnOperational)
-                    , _source(nullptr)
-                    , _interval( ((operationalInterval != 0) || (_memoryInterval != 0)) ? gcd(_operationalInterval, _memoryInterval) : 0 )
-                    , _active{ false }
-                    , _adminLock()
+                void Activated(RPC::IRemoteConnection* connection) override
                 {
-                    ASSERT((_operationalInterval != 0) || (_memoryInterval != 0));
+                    _parent.Connected(connection, true);
                 }
-                ~MonitorObject()
+                void Deactivated(RPC::IRemoteConnection* connection) override
                 {
-                    if (_source != nullptr) {
-                        _source->Release();
-                        _source = nullptr;
-                    }
+                    _parent.Connected(connection, false);
                 }
 
-                MonitorObject(MonitorObject&) = delete;
-                MonitorObject& operator=(MonitorObject&) = delete;
-                MonitorObject(MonitorObject&&) = delete;
-                MonitorObject& operator=(MonitorObject&&) = delete;
+                BEGIN_INTERFACE_MAP(Connections)
+                INTERFACE_ENTRY(RPC::IRemoteConnection::INotification)
+                END_INTERFACE_MAP
+
+            private:
+                MonitorObjects& _parent;
+            };
 
+            class Containment : public Core::IResource {
             public:
-                inline bool RegisterRestart(PluginHost::IShell::reason why VARIABLE_IS_NOT_USED)
-                {
-                    ASSERT(why == PluginHost::IShell::MEMORY_EXCEEDED || why == PluginHost::IShell::FAILURE);
-                    ASSERT(HasRestartAllowed());
-
-                    if (((_restartWindowStart.IsValid() == true) && (_restartWindowStart > Core::Time::Now())) || (_restartWindow == 0)) {
-                        // It's within window.
-                        _restartCount += _restartCount + 1;
-                    } else {
-                        _restartWindowStart = Core::Time::Now().Add(_restartWindow * 1000 /* ms */);
-                        _restartCount = 0;
-                    }
-                    
-                    bool result = ((_restartLimit == 0) || (_restartCount < _restartLimit));
-                    if (result == false) {
-                        _restartCount = 0;
-                    }
+                Containment() = delete;
+                Containment(const Containment&) = delete;
+                Containment& operator=(const Containment&) = delete;
 
-                    return result;
-                }
-                inline uint8_t RestartLimit() const
-                {
-                    return _restartLimit;
-                }
-                inline uint16_t RestartWindow() const
-                {
-                    return _restartWindow;
-                }
-                inline void UpdateRestartLimits(
-                    const uint16_t restartWindow,
-                    const uint8_t restartLimit)
+                explicit Containment(MonitorObjects& parent)
+                    : _parent(parent)
+                    , _watch()
                 {
-                    _restartWindow = restartWindow;
-                    _restartLimit = restartLimit;
                 }
-                inline bool HasRestartAllowed() const
-                {
-                    return (_operationalEvaluate);
-                }
-                inline uint32_t Interval() const
+                ~Containment() override = default;
+
+            public:
+                inline bool IsValid() const
                 {
-                    return (_interval);
+                    return (_watch.IsValid());
                 }
-                inline uint32_t Operational() const
+                inline int Add(const string& file)
                 {
-                    return (_operational);
+                    return (_watch.Add(file));
                 }
-                inline const MetaData& Measurement() const
+                inline void Remove(const int watch)
                 {
-                    Core::SafeSyncType<Core::CriticalSection> guard(_adminLock);
-                    return (_measurement);
+                    _watch.Remove(watch);
                 }
-                inline uint64_t TimeSlot() const
+
+                handle Descriptor() const override
                 {
-                    return (_nextSlot);
+                    return (_watch.Descriptor());
                 }
-                inline void Reset()
+                uint16_t Events() override
                 {
-                    Core::SafeSyncType<Core::CriticalSection> guard(_adminLock);
-                    _measurement.Reset();
+                    return (POLLIN);
                 }
-                inline void Retrigger(uint64_t currentSlot)
+                void Handle(const uint16_t events) override
                 {
-                    while (_nextSlot < currentSlot) {
-                        _nextSlot += _interval;
+                    if ((events & POLLIN) != 0) {
+                        for (const int watch : _watch.Read()) {
+                            _parent.Contained(watch);
+                        }
                     }
                 }
-                inline void Set(Exchange::IMemory* memory)
-                {
-                    _adminLock.Lock();
-                    if (_source != nullptr) {
-                        _source->Release();
-                        _source = nullptr;
-                    }
 
-                    if (memory != nullptr) {
-                        _source = memory;
-                        _source->AddRef();
-                    }
-                    _adminLock.Unlock();
+            private:
+                MonitorObjects& _parent;
+                CGroupWatch _watch;
+            };
 
-                    _operational = (memory != nullptr);
-                }
+            // Writes the flight recorder out, off the lifecycle notification that gave up on a plugin.
+            class DumpJob : public Core::IDispatch {
+            public:
+                DumpJob() = delete;
+                DumpJob(const DumpJob&) = delete;
+                DumpJob& operator=(const DumpJob&) = delete;
 
-                Core::ProxyType<const Exchange::IMemory> Source() const 
+                explicit DumpJob(MonitorObjects& parent)
+                    : _parent(parent)
                 {
-                    Core::ProxyType<const Exchange::IMemory> source;
-                    _adminLock.Lock();
-                    if(_source != nullptr) {
-                        source = Core::ProxyType<const Exchange::IMemory>(*_source, *_source);
-                    }
-                    _adminLock.Unlock();
-                    return source;
                 }
+                ~DumpJob() override = default;
 
-                inline uint32_t Evaluate()
+            public:
+                void Dispatch() override
                 {
-                    Core::ProxyType<const Exchange::IMemory> source = Source();
-
-                    uint32_t status(SUCCESFULL);
-                    if (source.IsValid() == true) {
-                        _operationalSlots -= _interval;
-                        _memorySlots -= _interval;
-
-                        if ((_operationalInterval != 0) && (_operationalSlots == 0)) {
-                            _operational = source->IsOperational();
-                            if (_operational == false) {
-                                status |= NOT_OPERATIONAL;
-                                TRACE(Trace::Error, (_T("Status not operational. %d"), __LINE__));
-                            }
-                            _operationalSlots = _operationalInterval;
-                        }
-                        if ((_memoryInterval != 0) && (_memorySlots == 0)) {
+                    _parent.Dump();
+                }
 
-                            uint64_t resident = source->Resident();
-                            uint64_t allocated = source->Allocated();
-                            uint64_t shared = source->Shared();
-                            uint64_t  process = source->Processes();
+            private:
+                MonitorObjects& _parent;
+            };
 
-                            _adminLock.Lock();
-                            _measurement.AddMeasurements(resident, allocated, shared, process);
-                            _adminLock.Unlock();
+            // Compresses and files the captures, off the thread that shut the plugin down.
+            class ArchiveJob : public Core::IDispatch {
+            public:
+                ArchiveJob() = delete;
+                ArchiveJob(const ArchiveJob&) = delete;
+                ArchiveJob& operator=(const ArchiveJob&) = delete;
 
-                            if ((_memoryThreshold != 0) && (resident > _memoryThreshold)) {
-                                status |= EXCEEDED_MEMORY;
-                                TRACE(Trace::Error, (_T("Status MetaData Exceeded. %d"), __LINE__));
-                            }
-                            _memorySlots = _memoryInterval;
-                        }
-                    }
-                    return (status);
+                explicit ArchiveJob(MonitorObjects& parent)
+                    : _parent(parent)
+                {
                 }
+                ~ArchiveJob() override = default;
 
-                bool IsActive() const { return _active; }
-                void Active(bool active) { _active = active; }
+            public:
+                void Dispatch() override
+                {
+                    _parent.Archive();
+                }
 
             private:
-                const uint32_t _operationalInterval; //!< Interval (s) to check the monitored processes
-                const uint32_t _memoryInterval; //!<  Interval (s) for a memory measurement.
-                const uint64_t _memoryThreshold; //!< MetaData threshold in bytes for all processes.
-                uint32_t _operationalSlots; // does not need protection, only touched in job evaluate
-                uint32_t _memorySlots; // does not need protection, only touched in job evaluate
-                std::atomic<uint64_t> _nextSlot; // no ordering needed, atomic should suffice
-                std::atomic<uint16_t> _restartWindow; // no ordering needed, atomic should suffice
-                Core::Time _restartWindowStart; // only used in job (indirectly), no protection needed
-                uint32_t _restartCount; // only used in job (indirectly), no protection needed
-                std::atomic<uint8_t> _restartLimit;  // no ordering needed, atomic should suffice
-                MetaData _measurement;
-                std::atomic<bool> _operational; // no ordering needed, atomic should suffice
-                const bool _operationalEvaluate;
-                Exchange::IMemory* _source;
-                const uint32_t _interval; //!< The greatest possible interval to check both memory and processes.
-                std::atomic<bool> _active;
-                mutable Core::CriticalSection _adminLock;
+                MonitorObjects& _parent;
             };
 
+            struct Capture {
+                uint64_t Time;
+                string Callsign;
+                uint32_t Pid;
+                string Text; //!< The header line, what is read from /proc is added when it is written.
+            };
+
+            static constexpr uint8_t PendingCaptures = 4;
+            static constexpr uint8_t ProbeThreads = 2;
+            static constexpr uint8_t SpareProbeThreads = 4; //!< Taking over from probes that hang, at most this many hang without holding up the others.
+
         public:
             MonitorObjects(const MonitorObjects&) = delete;
             MonitorObjects& operator=(const MonitorObjects&) = delete;
@@ -675,248 +1400,144 @@ PUSH_WARNING(DISABLE_WARNING_THIS_IN_MEMBER_INITIALIZER_LIST)
                 , _job(*this)
                 , _service(nullptr)
                 , _parent(*parent)
+                , _sender()
+                , _telemetry(_sender)
+                , _markers()
+                , _summaryInterval(0)
+                , _nextSummary(0)
+                , _overheadLock()
+                , _dispatchLatency()
+                , _lateness()
+                , _requests()
+                , _notifications()
+                , _activation()
+                , _enforcement()
+                , _startup(0)
+                , _ipcCalls(0)
+                , _budget(0)
+                , _largestFirst(false)
+                , _aggregate(0)
+                , _budgetLock()
+                , _cgroupRoot()
+                , _connections(*this)
+                , _containment(*this)
+                , _cgroupLock()
+                , _watches()
+                , _recorder()
+                , _dumpFile()
+                , _dumper()
+                , _dumping(false)
+                , _diagnostics()
+                , _archive()
+                , _captureBudget(0)
+                , _archiver()
+                , _captureLock()
+                , _captures()
+                , _probes()
+                , _registryLock()
             {
             }
 POP_WARNING()
             ~MonitorObjects() override
             {
-                ASSERT(_monitor.size() == 0);
+                ASSERT(_service == nullptr);
             }
 
         public:
             inline uint32_t Length() const
             {
-                return (static_cast<uint32_t>(_monitor.size()));
+                Core::SafeSyncType<Core::CriticalSection> guard(_registryLock);
+                return (static_cast<uint32_t>(std::count_if(_monitor.cbegin(), _monitor.cend(), [](const MonitorObjectContainer::value_type& element) { return (element.second.IsRetired() == false); })));
             }
             inline void Update(
                 const string& observable,
                 const uint16_t restartWindow,
                 const uint8_t restartLimit)
             {
-                MonitorObjectContainer::iterator index(_monitor.find(observable));
-                if (index != _monitor.end()) {
-                    index->second.UpdateRestartLimits(
+                const Entry info(Find(observable));
+                if (info.IsValid() == true) {
+                    info->UpdateRestartLimits(
                         restartWindow,
                         restartLimit);
                 }
             }
-            inline void Open(PluginHost::IShell* service, Core::JSON::ArrayType<Config::Entry>::Iterator& index)
-            {
-                ASSERT((service != nullptr) && (_service == nullptr));
-
-                uint64_t baseTime = Core::Time::Now().Ticks();
-
-                _service = service;
-                _service->AddRef();
-
-                while (index.Next() == true) {
-                    Config::Entry& element(index.Current());
-                    string callSign(element.Callsign.Value());
-                    uint64_t memoryThreshold(element.MetaDataLimit.Value());
-                    uint32_t interval = abs(element.Operational.Value());
-                    interval = interval * 1000 * 1000; // Move from Seconds to MicroSecond
-                    uint32_t memory(element.MetaData.Value() * 1000 * 1000); // Move from Seconds to MicroSeconds
-                    uint16_t restartWindow = 0;
-                    uint8_t restartLimit = 0;
-
-                    if (element.Restart.IsSet()) {
-                        restartWindow = element.Restart.Window;
-                        restartLimit = element.Restart.Limit;
-                    }
-                    SYSLOG(Logging::Startup, (_T("Monitoring: %s (%d,%d)."), callSign.c_str(), (interval / 1000000), (memory / 1000000)));
-                    if ((interval != 0) || (memory != 0)) {
-
-                        _monitor.emplace(std::piecewise_construct,
-                                         std::forward_as_tuple(callSign),
-                                         std::forward_as_tuple(
-                                            element.Operational.Value() >= 0, 
-                                            interval, 
-                                            memory, 
-                                            memoryThreshold, 
-                                            baseTime, 
-                                            restartWindow, 
-                                            restartLimit)
-                                    );
-                    }
-                }
-
-                _job.Submit();
-            }
-            inline void Close()
+            // Changes the limits and intervals of a monitored observable in one go, what is
+            // not set stays as it is. Reports the limits in effect from now on.
+            uint32_t Limits(const string& observable, const LimitsInfo& limits, LimitsInfo& result);
+            void Open(PluginHost::IShell* service, Config& config);
+            void Close();
+            inline string ConfigLine() const
             {
                 ASSERT(_service != nullptr);
-
-                _job.Revoke();
-
-                _monitor.clear();
-                _service->Release();
-                _service = nullptr;
-            }
-            void Activated (const string& callsign, PluginHost::IShell* service) override
-            {
-                MonitorObjectContainer::iterator index(_monitor.find(callsign));
-                
-
-                if (index != _monitor.end()) {
-
-                    index->second.Active(true);
-
-                    // Get the MetaData interface
-                    Exchange::IMemory* memory = service->QueryInterface<Exchange::IMemory>();
-
-                    if (memory != nullptr) {
-                        index->second.Set(memory);
-                        memory->Release();
-                    }
-
-                    if (_job.Submit() == true) {
-                        TRACE(Trace::Information, (_T("Starting to probe as active observee appeared.")));
-                    }
-
-                } 
-
-            }
-            void Deactivated (const string& callsign, PluginHost::IShell* service) override
-            {
+                return (_service->ConfigLine());
             }
+            // Brings the registry in line with a new list of observables: entries that are
+            // gone are retired, new ones start monitoring right away if their plugin runs,
+            // changed ones get their new settings on the next run of the job. Whatever was
+            // measured for an entry that stays is kept.
+            void Reload(const Core::JSON::ArrayType<Config::Entry>& observables, ReloadInfo& report);
+            void Activated (const string& callsign, PluginHost::IShell* service) override;
+            void Deactivated (const string& callsign, PluginHost::IShell* service) override;
             void Initialize(const string& callsign, PluginHost::IShell* service) override
             {
             }
-            void Deinitialized(const string& callsign, PluginHost::IShell* service) override
-            {
-                /* See comment in the Dispatch method on why no locking is here to protect the _monitor member */
-                MonitorObjectContainer::iterator index(_monitor.find(callsign));
-
-                if (index != _monitor.end()) {
-
-                    index->second.Set(nullptr);
-                    index->second.Active(false);
-
-                    PluginHost::IShell::reason reason = service->Reason();
-
-                    if ((index->second.HasRestartAllowed() == true) && ((reason == PluginHost::IShell::MEMORY_EXCEEDED) || (reason == PluginHost::IShell::FAILURE))) {
-                        if (index->second.RegisterRestart(reason) == false) {
-                            uint8_t restartlimit = index->second.RestartLimit();
-                            uint16_t restartwindow = index->second.RestartWindow();
-                            TRACE(Trace::Fatal, (_T("Giving up restarting of %s: Failed more than %d times within %d seconds."), callsign.c_str(), restartlimit, restartwindow));
-                            const string message("{\"callsign\": \"" + callsign + "\", \"action\": \"Restart\", \"reason\":\"" + (std::to_string(restartlimit)).c_str() + " Attempts Failed within the restart window\"}");
-                            _service->Notify(message);
-                            _parent.event_action(callsign, "StoppedRestaring", std::to_string(index->second.RestartLimit()) + " attempts failed within the restart window");
-                        } else {
-                            const string message("{\"callsign\": \"" + callsign + "\", \"action\": \"Activate\", \"reason\": \"Automatic\" }");
-                            _service->Notify(message);
-                            _parent.event_action(callsign, "Activate", "Automatic");
-                            TRACE(Trace::Error, (_T("Restarting %s again because we detected it misbehaved."), callsign.c_str()));
-                            Core::IWorkerPool::Instance().Submit(PluginHost::IShell::Job::Create(service, PluginHost::IShell::ACTIVATED, PluginHost::IShell::AUTOMATIC));
-                        }
-                    } 
-                }
-
-            }
+            void Deinitialized(const string& callsign, PluginHost::IShell* service) override;
             void Unavailable(const string&, PluginHost::IShell*) override
             {
             }
-            void Snapshot(Core::JSON::ArrayType<Monitor::Data>& snapshot) const
-            {
-                MonitorObjectContainer::const_iterator element(_monitor.cbegin());
-
-                // Go through the list of observations...
-                while (element != _monitor.cend()) {
-                    MetaData data = element->second.Measurement();
-                    if (data.HasMeasurements() == true) {
-                        snapshot.Add(Monitor::Data(element->first, data, element->second.Operational()));
-                    }
-                    element++;
-                }
-
-            }
-            bool Snapshot(const string& name, Monitor::MetaData& result, bool& operational) const
-            {
-                bool found = false;
-
-
-                MonitorObjectContainer::const_iterator index(_monitor.find(name));
-
-                if (index != _monitor.cend()) {
-                    MetaData data = index->second.Measurement();
-                    if (data.HasMeasurements() == true) {
-                        result = data;
-                        operational = index->second.Operational();
-                        found = true;
-                    }
-                }
-
-                return (found);
-            }
+            // No callsigns takes all observables.
+            void Snapshot(Core::JSON::ArrayType<Monitor::Data>& snapshot, const std::vector<string>& callsigns = std::vector<string>(), const Projection& projection = Projection()) const;
+            bool Snapshot(const string& name, const Projection& projection, Monitor::MetaData& result, bool& operational, uint64_t& generation) const;
 
-            void AddElementToRespone( Core::JSON::ArrayType<JsonData::Monitor::InfoInfo>& response, const string& callsign, const MonitorObject& object) const {
-                const MetaData& metaData = object.Measurement();
-                JsonData::Monitor::InfoInfo info;
+            void AddElementToRespone( Core::JSON::ArrayType<Monitor::Info>& response, const string& callsign, const MonitorObject& object, const Projection& projection) const {
+                const MetaData metaData(object.Measurement(projection));
+                Monitor::Info& info(response.Add());
                 info.Observable = callsign;
 
-                if (object.HasRestartAllowed()) {
+                if ((object.HasRestartAllowed()) && (projection.Has(Projection::RESTART) == true)) {
                     info.Restart.Limit = object.RestartLimit();
                     info.Restart.Window = object.RestartWindow();
                 }
 
-                if (metaData.HasMeasurements() == true) {
-                    translate(metaData.Allocated(), &info.Measurements.Allocated);
-                    translate(metaData.Resident(), &info.Measurements.Resident);
-                    translate(metaData.Shared(), &info.Measurements.Shared);
-                    translate(metaData.Process(), &info.Measurements.Process);
-                }
-                info.Measurements.Operational = object.Operational();
-                info.Measurements.Count = metaData.Allocated().Measurements();
-
-                response.Add(info);
+                // The rolling windows survive a resetstats, so they are reported even without lifetime samples.
+                info.Measurements.Set(metaData, object.Operational(), projection, (metaData.HasMeasurements() == true ? Projection::STATISTICS : 0), object.Generation());
             };
 
-            void Snapshot(const string& callsign, Core::JSON::ArrayType<JsonData::Monitor::InfoInfo>* response) const
+            void Snapshot(const string& callsign, Core::JSON::ArrayType<Monitor::Info>* response) const
             {
-
-                ASSERT(response != nullptr);
-
-                if (callsign.empty() == false) {
-                    auto element = _monitor.find(callsign);
-                    if (element != _monitor.end()) {
-                        AddElementToRespone(*response, element->first, element->second);
-                    }
-                } else {
-                    for (auto& element : _monitor) {
-                        AddElementToRespone(*response, element.first, element.second);
-                    }
-                }
+                Snapshot((callsign.empty() == true ? std::vector<string>() : std::vector<string>(1, callsign)), Projection(), response);
             }
-
-            bool Reset(const string& name, Monitor::MetaData& result, bool& operational)
+            // No callsigns takes all observables, unknown ones and those that did not change since the
+            // generation the projection asks for are left out.
+            void Snapshot(const std::vector<string>& callsigns, const Projection& projection, Core::JSON::ArrayType<Monitor::Info>* response) const;
+            bool IsMonitored(const string& callsign) const
             {
-                bool found = false;
-
-                MonitorObjectContainer::iterator index(_monitor.find(name));
-
-                if (index != _monitor.end()) {
-                    result = index->second.Measurement();
-                    operational = index->second.Operational();
-                    index->second.Reset();
-                    found = true;
-                }
-
-                return (found);
+                Core::SafeSyncType<Core::CriticalSection> guard(_registryLock);
+                MonitorObjectContainer::const_iterator element(_monitor.find(callsign));
+                return ((element != _monitor.cend()) && (element->second.IsRetired() == false));
             }
+            // Of the latest change to any of the observables, all of them if there are no callsigns.
+            uint64_t Generation(const std::vector<string>& callsigns) const;
 
-            bool Reset(const string& name)
+            void Handled(const uint64_t duration) const
+            {
+                _overheadLock.Lock();
+                _requests.Set(duration);
+                _overheadLock.Unlock();
+            }
+            void Notified(const uint64_t duration)
             {
-                bool found = false;
+                _overheadLock.Lock();
+                _notifications.Set(duration);
+                _overheadLock.Unlock();
+            }
 
-                MonitorObjectContainer::iterator index(_monitor.find(name));
+            void Overhead(SelfInfo& response) const;
+            void Recorded(RecorderInfo& response) const;
 
-                if (index != _monitor.end()) {
-                    index->second.Reset();
-                    found = true;
-                }
+            bool Reset(const string& name, Monitor::MetaData& result, bool& operational);
 
-                return (found);
-            }
+            bool Reset(const string& name);
 
             BEGIN_INTERFACE_MAP(MonitorObjects)
             INTERFACE_ENTRY(PluginHost::IPlugin::INotification)
@@ -925,93 +1546,242 @@ POP_WARNING()
 
         private:
             friend Core::ThreadPool::JobType<MonitorObjects&>;
-
-            void Dispatch()
+#if defined(UNIT_TEST) || defined(MONITOR_REPLAY)
+            friend class MonitorTest;
+            friend class MonitorBenchmark;
+            friend class MonitorReplay;
+#endif
+
+            // From the worker pool, replaces what an earlier dump left.
+            void Dump();
+            // From the worker pool, till no capture is left waiting. The process is read here,
+            // not on the enforcement path, so a /proc read that blocks never holds up a shutdown.
+            void Archive();
+
+            void Dispatch();
+
+            // From a probe thread, true if the probe was given up on while it ran.
+            bool Probe(const string& callsign, const uint32_t ticket);
+
+            // Book keeping after a probe, on whatever thread ran it.
+            void Probed(const string& callsign, MonitorObject& info, const uint32_t value);
+
+            // Shuts observables down, in the order the policy picks them, until what
+            // is left fits the budget again. Costs nothing as long as it fits.
+            void Balance();
+            inline bool Preferred(const MonitorObject& candidate, const MonitorObject& current) const
             {
-                uint64_t scheduledTime(Core::Time::Now().Ticks());
-                uint64_t nextSlot(static_cast<uint64_t>(~0));
-
-                MonitorObjectContainer::iterator index(_monitor.begin());
-
-                // Go through the list of pending observations...
-                while (index != _monitor.end()) {
-                    MonitorObject& info(index->second);
-                    if (info.IsActive() == false) {
-                        ++index;
-                        continue;
-                    }
-
-                    if (info.TimeSlot() <= scheduledTime) {
-                        uint32_t value(info.Evaluate());
+                return ((_largestFirst == false) && (candidate.Priority() != current.Priority()) ? (candidate.Priority() < current.Priority()) : (candidate.Resident() > current.Resident()));
+            }
 
-                        if ((value & (MonitorObject::NOT_OPERATIONAL | MonitorObject::EXCEEDED_MEMORY)) != 0) {
-                            PluginHost::IShell* plugin(_service->QueryInterfaceByCallsign<PluginHost::IShell>(index->first));
+            void Connected(RPC::IRemoteConnection* connection, const bool up);
+            // Moves the host process of an observable into its own group, with memory.max at
+            // its memory limit and memory.high at its soft limit, or a tenth below the limit.
+            void Confine(const string& callsign, const uint32_t pid);
+            void Limit(CGroup& group, const MonitorObject& info)
+            {
+                if (group.Limit(info.PressureThreshold(), info.MemoryThreshold()) == false) {
+                    TRACE(Trace::Error, (_T("Could not set the memory limits of %s."), group.Path().c_str()));
+                }
+            }
+            void Release(const string& callsign);
+            // The kernel counted reclaim or OOM in the group of an observable.
+            void Contained(const int watch);
 
-                            if (plugin != nullptr) {
-                                Core::EnumerateType<PluginHost::IShell::reason> why(((value & MonitorObject::EXCEEDED_MEMORY) != 0) ? PluginHost::IShell::MEMORY_EXCEEDED : PluginHost::IShell::FAILURE);
+            void Enforce(const string& callsign, MonitorObject& info, const uint32_t value);
+            // Only the processes over the limit of their role go, the observable itself keeps running.
+            void Kill(const string& callsign, const std::vector<ProcessRoles::Culprit>& culprits);
 
-                                const string message("{\"callsign\": \"" + plugin->Callsign() + "\", \"action\": \"Deactivate\", \"reason\": \"" + why.Data() + "\" }");
-                                SYSLOG(Logging::Fatal, (_T("FORCED Shutdown: %s by reason: %s."), plugin->Callsign().c_str(), why.Data()));
+            // Has the worker pool read what the process tree of the observable looks like while it is
+            // taken down, for as long as the budget allows, and write it out.
+            void Diagnose(const string& callsign, const MonitorObject& info, const string& reason);
 
-                                auto callsign = plugin->Callsign();
-                                auto reason   = why.Data();
-                                
-                                if (!callsign.empty() && reason &&
-                                    std::string(callsign) == "JSPP" &&
-                                    std::string(reason) == "Failure") {
-                                
-                                    t2_event_d("SYST_INFO_JSPPShutdown", 1);
-                                }
+            // One "callsign:last:max" (KiB resident) entry per active observable.
+            void Summarize();
 
-                                _service->Notify(message);
+            // Seconds to MicroSeconds, an interval longer than an observable can hold is cut to the longest one.
+            static uint32_t Interval(const uint32_t seconds)
+            {
+                return (static_cast<uint32_t>(static_cast<uint64_t>(seconds < MonitorObject::MaxInterval ? seconds : MonitorObject::MaxInterval) * 1000 * 1000));
+            }
+            // Operational intervals are negative to only observe.
+            static uint32_t Seconds(const int32_t interval)
+            {
+                return (interval < 0 ? static_cast<uint32_t>(-static_cast<int64_t>(interval)) : static_cast<uint32_t>(interval));
+            }
+            static MonitorObject::Settings Configuration(const Config::Entry& element)
+            {
+                MonitorObject::Settings settings;
+                const uint32_t memory(Interval(element.MetaData.Value()));
+
+                settings.ActOnOperational = (element.Operational.Value() >= 0);
+                settings.Operational = Interval(Seconds(element.Operational.Value()));
+                settings.Memory = memory;
+                settings.MemoryMin = (element.Adaptive.Min.IsSet() == true ? Interval(element.Adaptive.Min.Value()) : memory);
+                settings.MemoryMax = (element.Adaptive.Max.IsSet() == true ? Interval(element.Adaptive.Max.Value()) : memory);
+                settings.Threshold = element.MetaDataLimit.Value();
+                settings.SoftThreshold = element.MetaDataSoftLimit.Value();
+                if ((settings.Threshold != 0) && (settings.SoftThreshold >= settings.Threshold)) {
+                    // Pressure would never come before the deactivation.
+                    SYSLOG(Logging::Startup, (_T("Soft memory limit of %s is not below its memory limit, it is ignored."), element.Callsign.Value().c_str()));
+                    settings.SoftThreshold = 0;
+                }
+                if (element.MetaDataGrace.IsSet() == true) {
+                    settings.Grace = static_cast<uint64_t>(element.MetaDataGrace.Value()) * 1000 * 1000; // Move from Seconds to MicroSeconds
+                } else {
+                    settings.Grace = MonitorObject::NoGrace;
+                }
+                settings.Rule = Violation(element.Rule.Samples.Value(), element.Rule.Window.Value(), static_cast<uint64_t>(element.Rule.Sustain.Value()) * 1000 * 1000); // Move from Seconds to MicroSeconds
+                settings.Clearance = element.Rule.Hysteresis.Value();
+                settings.ProbeTimeout = static_cast<uint64_t>(element.ProbeTimeout.Value()) * 1000 * 1000; // Move from Seconds to MicroSeconds
+                settings.Background = static_cast<uint64_t>(element.Suspended.Value()) * 1000 * 1000; // Move from Seconds to MicroSeconds
+                settings.Priority = element.Priority.Value();
+                settings.RestartWindow = 0;
+                settings.RestartLimit = 0;
+                settings.FailureMarker = element.FailureMarker.Value();
+                settings.Breakdown = element.Breakdown.Value();
+                settings.Graphics = element.Graphics.Value();
+                settings.GraphicsThreshold = element.GraphicsLimit.Value();
+
+                Core::JSON::ArrayType<Config::Role>::ConstIterator role(element.Roles.Elements());
+                while (role.Next() == true) {
+                    settings.Roles.push_back({ role.Current().Name.Value(), role.Current().MetaDataLimit.Value(), (role.Current().Scope.Value() == _T("process")) });
+                }
 
-                                _parent.event_action(plugin->Callsign(), "Deactivate", why.Data());
+                if (element.Restart.IsSet()) {
+                    settings.RestartWindow = element.Restart.Window.Value();
+                    settings.RestartLimit = element.Restart.Limit.Value();
+                }
+                if ((element.FailureMarker.IsSet() == false) && (element.Callsign.Value() == _T("JSPP"))) {
+                    // Kept for the dashboards that were built on the original, hard wired, marker.
+                    settings.FailureMarker = _T("SYST_INFO_JSPPShutdown");
+                }
 
-                                Core::IWorkerPool::Instance().Submit(PluginHost::IShell::Job::Create(plugin, PluginHost::IShell::DEACTIVATED, why.Value()));
+                return (settings);
+            }
+            // What Find hands out, the entry is not erased for as long as it is held, so it
+            // can be used without holding the registry lock.
+            class Entry {
+            public:
+                Entry() = delete;
+                Entry(const Entry&) = delete;
+                Entry& operator=(const Entry&) = delete;
 
-                                plugin->Release();
-                            }
-                        }
-                        info.Retrigger(scheduledTime);
+                // Only with the registry lock taken.
+                explicit Entry(MonitorObject* info)
+                    : _info(info)
+                {
+                    if (_info != nullptr) {
+                        _info->Pin();
                     }
-
-                    if (info.TimeSlot() < nextSlot) {
-                        nextSlot = info.TimeSlot();
+                }
+                Entry(Entry&& move)
+                    : _info(move._info)
+                {
+                    move._info = nullptr;
+                }
+                ~Entry()
+                {
+                    if (_info != nullptr) {
+                        _info->Unpin();
                     }
-
-                    index++;
                 }
 
-                if (nextSlot != static_cast<uint64_t>(~0)) {
-                    if (nextSlot < Core::Time::Now().Ticks()) {
-                        _job.Submit();
-                    } else {
-                        nextSlot += 1000 /* Add 1 ms */;
-                        _job.Reschedule(nextSlot);
-                    }
-                } else {
-                    TRACE(Trace::Information, (_T("Stopping to probe due to lack of active observees.")));
+            public:
+                inline bool IsValid() const
+                {
+                    return (_info != nullptr);
                 }
+                inline MonitorObject* operator->() const
+                {
+                    return (_info);
+                }
+                inline MonitorObject& operator*() const
+                {
+                    return (*_info);
+                }
+
+            private:
+                MonitorObject* _info;
+            };
+
+            // Retired entries are only erased by the job, see Purge, once nothing holds on to them.
+            inline Entry Find(const string& callsign)
+            {
+                Core::SafeSyncType<Core::CriticalSection> guard(_registryLock);
+                MonitorObjectContainer::iterator index(_monitor.find(callsign));
+                return (Entry(index != _monitor.end() ? &(index->second) : nullptr));
             }
+            // From the job, before it takes the entries to probe: what was retired, released and
+            // is no longer held by anyone is erased.
+            void Purge();
+            std::vector<MonitorObjectContainer::value_type*> Registry();
+            void Insert(const string& callsign, const MonitorObject::Settings& settings, const uint64_t now)
+            {
+                Core::SafeSyncType<Core::CriticalSection> guard(_registryLock);
 
-        private:
-            template <typename T>
-            void translate(const Core::MeasurementType<T>& from, JsonData::Monitor::MeasurementInfo* to) const
+                _monitor.emplace(std::piecewise_construct,
+                    std::forward_as_tuple(callsign),
+                    std::forward_as_tuple(callsign, settings, now));
+            }
+            // A pending change should not wait for the slot the job was scheduled for, it is pulled
+            // forward to now. Does not wait for a run of the job that is in progress.
+            inline void Replan()
             {
-                to->Min = from.Min();
-                to->Max = from.Max();
-                to->Average = from.Average();
-                to->Last = from.Last();
+                _job.Reschedule(Clock::Now());
             }
+            // What Deinitialized does, without the restart.
+            void Retire(const string& callsign);
 
         private:
 
-            using MonitorObjectContainer = std::unordered_map<string, MonitorObject>;
+            struct Markers {
+                string Deactivate;
+                string Restart;
+                string GiveUp;
+                string Memory;
+                string Pressure;
+            };
 
             MonitorObjectContainer _monitor;
             Core::WorkerPool::JobType<MonitorObjects&> _job;
             PluginHost::IShell* _service;
             Monitor& _parent;
+            Telemetry::BusSender _sender;
+            Telemetry _telemetry;
+            Markers _markers;
+            uint64_t _summaryInterval;
+            uint64_t _nextSummary; // only used in job, no protection needed
+            mutable Core::CriticalSection _overheadLock;
+            Latency _dispatchLatency;
+            Latency _lateness;
+            mutable Latency _requests;
+            Latency _notifications;
+            Latency _activation;
+            Latency _enforcement;
+            uint64_t _startup;
+            std::atomic<uint32_t> _ipcCalls; // no ordering needed, atomic should suffice
+            uint64_t _budget; //!< Bytes resident for all observables together, 0 for no budget.
+            bool _largestFirst;
+            std::atomic<uint64_t> _aggregate; //!< Resident size of all running observables, kept up to date per sample.
+            Core::CriticalSection _budgetLock;
+            string _cgroupRoot; //!< Empty if observables are not confined to cgroups.
+            Core::Sink<Connections> _connections;
+            Containment _containment;
+            Core::CriticalSection _cgroupLock;
+            std::map<int, string> _watches; //!< memory.events watch to callsign.
+            Recorder _recorder;
+            string _dumpFile;
+            Core::ProxyType<Core::IDispatch> _dumper;
+            std::atomic<bool> _dumping; //!< A dump is queued, a give up in the meantime is in it as well.
+            Diagnostics _diagnostics;
+            DiagnosticsArchive _archive; //!< Not valid if no diagnostics are captured.
+            uint64_t _captureBudget; //!< MicroSeconds a capture may take.
+            Core::ProxyType<Core::IDispatch> _archiver;
+            Core::CriticalSection _captureLock;
+            std::list<Capture> _captures; //!< The first one is being written, the job is queued as long as there are any.
+            Prober _probes; //!< Probes of observables with a timeout.
+            mutable Core::CriticalSection _registryLock; //!< Guards the shape of _monitor, not the entries in it.
         };
 
     public:
@@ -1065,6 +1835,13 @@ POP_WARNING()
         Core::ProxyType<Web::Response> Process(const Web::Request& request) override;
 
     private:
+#if defined(UNIT_TEST) || defined(MONITOR_REPLAY)
+        // The L1 tests, the benchmarks and the replay tool drive observables directly, with a manual clock.
+        friend class MonitorTest;
+        friend class MonitorBenchmark;
+        friend class MonitorReplay;
+#endif
+
         uint8_t _skipURL;
         Config _config;
         Core::Sink<MonitorObjects> _monitor;
@@ -1073,9 +1850,14 @@ POP_WARNING()
         void RegisterAll();
         void UnregisterAll();
         uint32_t endpoint_restartlimits(const JsonData::Monitor::RestartlimitsParamsData& params);
-        uint32_t endpoint_resetstats(const JsonData::Monitor::ResetstatsParamsData& params, JsonData::Monitor::InfoInfo& response);
-        uint32_t get_status(const string& index, Core::JSON::ArrayType<JsonData::Monitor::InfoInfo>& response) const;
+        uint32_t endpoint_resetstats(const JsonData::Monitor::ResetstatsParamsData& params, Info& response);
+        uint32_t get_status(const string& index, Core::JSON::ArrayType<Info>& response) const;
+        uint32_t get_selfstats(SelfInfo& response) const;
+        uint32_t endpoint_reloadconfig(const Config& params, ReloadInfo& response);
+        uint32_t endpoint_setlimits(const LimitsParamsInfo& params, LimitsInfo& response);
+        uint32_t endpoint_dumprecorder(RecorderInfo& response);
         void event_action(const string& callsign, const string& action, const string& reason);
+        void event_memorypressure(const string& callsign, const uint64_t resident, const uint64_t limit);
     };
 }
 }
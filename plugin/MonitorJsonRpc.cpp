@@ -33,8 +33,12 @@ namespace Plugin {
     void Monitor::RegisterAll()
     {
         Register<RestartlimitsParamsData,void>(_T("restartlimits"), &Monitor::endpoint_restartlimits, this);
-        Register<ResetstatsParamsData,InfoInfo>(_T("resetstats"), &Monitor::endpoint_resetstats, this);
-        Property<Core::JSON::ArrayType<InfoInfo>>(_T("status"), &Monitor::get_status, nullptr, this);
+        Register<ResetstatsParamsData,Info>(_T("resetstats"), &Monitor::endpoint_resetstats, this);
+        Property<Core::JSON::ArrayType<Info>>(_T("status"), &Monitor::get_status, nullptr, this);
+        Property<SelfInfo>(_T("selfstats"), &Monitor::get_selfstats, nullptr, this);
+        Register<Config,ReloadInfo>(_T("reloadconfig"), &Monitor::endpoint_reloadconfig, this);
+        Register<LimitsParamsInfo,LimitsInfo>(_T("setlimits"), &Monitor::endpoint_setlimits, this);
+        Register<void,RecorderInfo>(_T("dumprecorder"), &Monitor::endpoint_dumprecorder, this);
     }
 
     void Monitor::UnregisterAll()
@@ -42,6 +46,10 @@ namespace Plugin {
         Unregister(_T("resetstats"));
         Unregister(_T("restartlimits"));
         Unregister(_T("status"));
+        Unregister(_T("selfstats"));
+        Unregister(_T("reloadconfig"));
+        Unregister(_T("setlimits"));
+        Unregister(_T("dumprecorder"));
     }
 
     // API implementation
@@ -52,36 +60,105 @@ namespace Plugin {
     //  - ERROR_NONE: Success
     uint32_t Monitor::endpoint_restartlimits(const RestartlimitsParamsData& params)
     {
+        const uint64_t start = Clock::Now();
         const string& callsign = params.Callsign.Value();
         _monitor.Update(
             callsign,
             params.Restart.Window.Value(), params.Restart.Limit.Value());
+        _monitor.Handled(Clock::Now() - start);
+        return Core::ERROR_NONE;
+    }
+
+    // Method: setlimits - Sets new memory limits and intervals for a plugin, they are in effect from the next monitor run
+    // Return codes:
+    //  - ERROR_NONE: Success
+    //  - ERROR_UNKNOWN_KEY: The plugin is not monitored
+    //  - ERROR_BAD_REQUEST: Both the memory and the operational interval would be 0
+    uint32_t Monitor::endpoint_setlimits(const LimitsParamsInfo& params, LimitsInfo& response)
+    {
+        const uint64_t start = Clock::Now();
+        const uint32_t result = _monitor.Limits(params.Callsign.Value(), params.Limits, response);
+        _monitor.Handled(Clock::Now() - start);
+        return (result);
+    }
+
+    // Method: dumprecorder - The flight recorder: the latest samples, memory pressure, deactivations, restarts and give ups, oldest first
+    // Return codes:
+    //  - ERROR_NONE: Success
+    uint32_t Monitor::endpoint_dumprecorder(RecorderInfo& response)
+    {
+        const uint64_t start = Clock::Now();
+        _monitor.Recorded(response);
+        _monitor.Handled(Clock::Now() - start);
         return Core::ERROR_NONE;
     }
 
     // Method: resetstats - Resets memory and process statistics for a single plugin watched by the Monitor
     // Return codes:
     //  - ERROR_NONE: Success
-    uint32_t Monitor::endpoint_resetstats(const ResetstatsParamsData& params, InfoInfo& response)
+    uint32_t Monitor::endpoint_resetstats(const ResetstatsParamsData& params, Info& response)
     {
+        const uint64_t start = Clock::Now();
         const string& callsign = params.Callsign.Value();
 
-        Core::JSON::ArrayType<InfoInfo> info;
+        Core::JSON::ArrayType<Info> info;
         _monitor.Snapshot(callsign, &info);
         if (info.Length() == 1) {
             _monitor.Reset(callsign);
             response = info[0];
         }
+        _monitor.Handled(Clock::Now() - start);
+        return Core::ERROR_NONE;
+    }
+
+    // Property: status - The memory and process statistics either for a single plugin, a list of them or all plugins watched by the Monitor
+    //         The index is a comma separated list of callsigns, optionally followed by ?fields= and a comma separated list of fields.
+    //         With &since=<generation> only the observables that changed after that generation are returned.
+    // Return codes:
+    //  - ERROR_NONE: Success
+    //  - ERROR_BAD_REQUEST: A field that is not known
+    uint32_t Monitor::get_status(const string& index, Core::JSON::ArrayType<Info>& response) const
+    {
+        const uint64_t start = Clock::Now();
+        std::vector<string> callsigns;
+        Projection projection;
+        uint32_t result = Core::ERROR_BAD_REQUEST;
+
+        if (Projection::Parse(index, callsigns, projection) == true) {
+            _monitor.Snapshot(callsigns, projection, &response);
+            result = Core::ERROR_NONE;
+        }
+        _monitor.Handled(Clock::Now() - start);
+        return (result);
+    }
+
+    // Property: selfstats - What the Monitor itself costs: scheduler, evaluation, IPC and request handling
+    // Return codes:
+    //  - ERROR_NONE: Success
+    uint32_t Monitor::get_selfstats(SelfInfo& response) const
+    {
+        _monitor.Overhead(response);
         return Core::ERROR_NONE;
     }
 
-    // Property: status - The memory and process statistics either for a single plugin or all plugins watched by the Monitor
+    // Method: reloadconfig - Applies a new list of observables without restarting the Monitor, measurements of the ones that stay are kept
+    //         Takes the configuration in the format of the plugin configuration. Without observables the configuration the framework
+    //         holds for the Monitor (its config line: as activated, or as set through the Controller since) is applied again, not the file on disk.
     // Return codes:
     //  - ERROR_NONE: Success
-    uint32_t Monitor::get_status(const string& index, Core::JSON::ArrayType<InfoInfo>& response) const
+    uint32_t Monitor::endpoint_reloadconfig(const Config& params, ReloadInfo& response)
     {
-        const string& callsign = index;
-        _monitor.Snapshot(callsign, &response);
+        const uint64_t start = Clock::Now();
+
+        if (params.Observables.IsSet() == true) {
+            _monitor.Reload(params.Observables, response);
+        } else {
+            Config config;
+            config.FromString(_monitor.ConfigLine());
+            _monitor.Reload(config.Observables, response);
+        }
+
+        _monitor.Handled(Clock::Now() - start);
         return Core::ERROR_NONE;
     }
 
@@ -95,5 +172,16 @@ namespace Plugin {
 
         Notify(_T("action"), params);
     }
+
+    // Event: memorypressure - Observable went over its soft memory limit and should release what it can
+    void Monitor::event_memorypressure(const string& callsign, const uint64_t resident, const uint64_t limit)
+    {
+        PressureInfo params;
+        params.Callsign = callsign;
+        params.Resident = resident;
+        params.Limit = limit;
+
+        Notify(_T("memorypressure"), params);
+    }
 } // namespace Plugin
 }
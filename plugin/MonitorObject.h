@@ -0,0 +1,1340 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __MONITOR_OBJECT_H
+#define __MONITOR_OBJECT_H
+
+#include "Module.h"
+#include "CGroup.h"
+#include "Clock.h"
+#include "DmaBuf.h"
+#include "Processes.h"
+#include "Projection.h"
+#include "Rules.h"
+#include "Statistics.h"
+#include <interfaces/IMemory.h>
+#include <interfaces/IStateControl.h>
+#include <limits>
+#include <string>
+
+static uint32_t gcd(uint32_t a, uint32_t b)
+{
+    return b == 0 ? a : gcd(b, a % b);
+}
+
+namespace WPEFramework {
+namespace Plugin {
+
+    // One plugin the Monitor watches: what the configuration asks for, what was
+    // measured of it and the interfaces it is probed through. The registry of
+    // Monitor::MonitorObjects holds one per observable, the replay tool drives
+    // one on its own.
+    class MonitorObject {
+    public:
+        class MetaData {
+        public:
+            // A process of the observable, sizes in bytes.
+            struct Child {
+                uint32_t Pid;
+                string Name;
+                Core::MeasurementType<uint64_t> Resident;
+                Core::MeasurementType<uint64_t> Proportional;
+            };
+
+        public:
+            MetaData()
+                : _lifetime()
+                , _distribution()
+                , _recent()
+                , _children()
+            {
+            }
+            MetaData(const MetaData& copy) = default;
+            // Only what the projection asks for. The lifetime statistics, a few scalars per metric,
+            // are always taken, the distributions, windows and processes only if they are reported.
+            MetaData(const MetaData& copy, const Projection& projection)
+                : _lifetime()
+                , _distribution()
+                , _recent()
+                , _children()
+            {
+                for (uint8_t index = 0; index < Metrics::METRICS; index++) {
+                    _lifetime[index] = copy._lifetime[index];
+                }
+                for (uint8_t index = 0; index < Metrics::HISTORIES; index++) {
+                    const uint8_t statistics = projection.Statistics(static_cast<Metrics::metric>(index));
+
+                    if ((statistics & (Projection::P50 | Projection::P95 | Projection::P99)) != 0) {
+                        _distribution[index] = copy._distribution[index];
+                    }
+                    if ((statistics & Projection::RECENT) != 0) {
+                        _recent[index] = copy._recent[index];
+                    }
+                }
+                if (projection.Has(Projection::PROCESSES) == true) {
+                    _children = copy._children;
+                }
+            }
+            MetaData& operator=(const MetaData& rhs) = default;
+            ~MetaData()
+            {
+            }
+
+        public:
+            bool HasMeasurements() const {
+                bool result = false;
+
+                for (uint8_t index = 0; (result == false) && (index < Metrics::METRICS); index++) {
+                    result = (_lifetime[index].Measurements() != 0);
+                }
+
+                return (result);
+            }
+
+            // The distribution and the rolling windows only for a metric with a history.
+            void Add(const Metrics::metric which, const uint64_t value, const uint64_t now /* MicroSeconds */)
+            {
+                _lifetime[which].Set(value);
+
+                if (Metrics::HasHistory(which) == true) {
+                    _distribution[which].Set(value);
+                    _recent[which].Set(value, now);
+                }
+            }
+            void AddMeasurements(const uint64_t resident, const uint64_t allocated, const uint64_t shared, const uint64_t process) {
+                const uint64_t now = Clock::Now();
+
+                Add(Metrics::RESIDENT, resident, now);
+                Add(Metrics::ALLOCATED, allocated, now);
+                Add(Metrics::SHARED, shared, now);
+                Add(Metrics::PROCESS, process, now);
+            }
+
+            void Measure(Exchange::IMemory* memInterface)
+            {
+                AddMeasurements(memInterface->Resident(), memInterface->Allocated(), memInterface->Shared(), memInterface->Processes());
+            }
+            // A process keeps its measurements as long as it is around, one that is gone is dropped.
+            void AddProcesses(const std::vector<ProcessTree::Process>& processes)
+            {
+                std::vector<Child> children;
+
+                children.reserve(processes.size());
+
+                for (const ProcessTree::Process& process : processes) {
+                    std::vector<Child>::iterator index(std::find_if(_children.begin(), _children.end(), [&process](const Child& child) { return ((child.Pid == process.Pid) && (child.Name == process.Name)); }));
+
+                    if (index != _children.end()) {
+                        children.push_back(std::move(*index));
+                    } else {
+                        children.push_back({ process.Pid, process.Name, Core::MeasurementType<uint64_t>(), Core::MeasurementType<uint64_t>() });
+                    }
+
+                    children.back().Resident.Set(process.Resident);
+                    children.back().Proportional.Set(process.Proportional);
+                }
+
+                _children = std::move(children);
+            }
+            void Reset()
+            {
+                for (Core::MeasurementType<uint64_t>& lifetime : _lifetime) {
+                    lifetime.Reset();
+                }
+                for (Histogram& distribution : _distribution) {
+                    distribution.Reset();
+                }
+                for (Child& child : _children) {
+                    child.Resident.Reset();
+                    child.Proportional.Reset();
+                }
+                // The rolling windows age out by themselves, a reset leaves them
+                // untouched so recent behaviour stays visible.
+            }
+
+        public:
+            // No measurements for a Metrics::SPARSE metric the observable is not configured for.
+            inline const Core::MeasurementType<uint64_t>& Lifetime(const Metrics::metric which) const
+            {
+                return (_lifetime[which]);
+            }
+            // Nullptr for a metric without a history.
+            inline const Histogram* Distribution(const Metrics::metric which) const
+            {
+                return (Metrics::HasHistory(which) == true ? &_distribution[which] : nullptr);
+            }
+            inline const Windows* Recent(const Metrics::metric which) const
+            {
+                return (Metrics::HasHistory(which) == true ? &_recent[which] : nullptr);
+            }
+            // Empty unless the breakdown is configured for the observable.
+            inline const std::vector<Child>& Children() const
+            {
+                return (_children);
+            }
+        private:
+            Core::MeasurementType<uint64_t> _lifetime[Metrics::METRICS];
+            Histogram _distribution[Metrics::HISTORIES];
+            Windows _recent[Metrics::HISTORIES];
+            std::vector<Child> _children;
+        };
+
+    public:
+        MonitorObject() = delete;
+        MonitorObject& operator=(const MonitorObject&) = delete;
+
+        enum evaluation {
+            SUCCESFULL = 0x00,
+            NOT_OPERATIONAL = 0x01,
+            EXCEEDED_MEMORY = 0x02,
+            UNRESPONSIVE = 0x04,
+            MEMORY_PRESSURE = 0x08,
+            EXCEEDED_BUDGET = 0x10,
+            EXCEEDED_PROCESS = 0x20,
+            EXCEEDED_GRAPHICS = 0x40
+        };
+
+        static constexpr uint64_t ABANDONED = static_cast<uint64_t>(~0); //!< Probe start of a timed out probe that still has to return.
+        static constexpr uint64_t NoGrace = static_cast<uint64_t>(~0); //!< Grace period that never ends, the hard limit is left to deactivate.
+        static constexpr uint32_t MaxInterval = std::numeric_limits<uint32_t>::max() / (1000 * 1000); //!< Seconds, intervals are kept in 32 bits of MicroSeconds.
+
+        typedef struct {
+            int32_t Limit;
+            int32_t WindowSeconds;
+        } RestartSettings;
+
+        // What the configuration asks for, intervals and durations in MicroSeconds, limits in KiB.
+        struct Settings {
+            bool ActOnOperational;
+            uint32_t Operational;
+            uint32_t Memory;
+            uint32_t MemoryMin;
+            uint32_t MemoryMax;
+            uint64_t Threshold;
+            uint64_t SoftThreshold;
+            uint64_t Grace;
+            Violation Rule;
+            uint8_t Clearance;
+            uint64_t ProbeTimeout;
+            uint64_t Background;
+            uint8_t Priority;
+            uint16_t RestartWindow;
+            uint8_t RestartLimit;
+            string FailureMarker;
+            bool Breakdown;
+            std::vector<ProcessRoles::Role> Roles;
+            bool Graphics;
+            uint64_t GraphicsThreshold;
+
+            bool operator==(const Settings& rhs) const
+            {
+                return ((ActOnOperational == rhs.ActOnOperational) && (Operational == rhs.Operational) && (Memory == rhs.Memory)
+                    && (MemoryMin == rhs.MemoryMin) && (MemoryMax == rhs.MemoryMax) && (Threshold == rhs.Threshold)
+                    && (SoftThreshold == rhs.SoftThreshold) && (Grace == rhs.Grace) && (Rule.Samples() == rhs.Rule.Samples())
+                    && (Rule.Window() == rhs.Rule.Window()) && (Rule.Sustain() == rhs.Rule.Sustain()) && (Clearance == rhs.Clearance)
+                    && (ProbeTimeout == rhs.ProbeTimeout) && (Background == rhs.Background) && (Priority == rhs.Priority)
+                    && (RestartWindow == rhs.RestartWindow) && (RestartLimit == rhs.RestartLimit) && (FailureMarker == rhs.FailureMarker)
+                    && (Breakdown == rhs.Breakdown) && (Roles == rhs.Roles) && (Graphics == rhs.Graphics)
+                    && (GraphicsThreshold == rhs.GraphicsThreshold));
+            }
+            bool operator!=(const Settings& rhs) const
+            {
+                return (!operator==(rhs));
+            }
+        };
+
+        // What Enforce reports about an observable, built once instead of on every violation.
+        class Notices {
+        public:
+            enum reason : uint8_t {
+                MEMORY = 0,
+                FAILURE = 1,
+                BUDGET = 2,
+                UNRESPONSIVE = 3,
+                REASONS = 4
+            };
+
+        public:
+            Notices() = delete;
+            Notices(const Notices&) = delete;
+            Notices& operator=(const Notices&) = delete;
+
+            explicit Notices(const string& callsign)
+                : _restart("{\"callsign\": \"" + callsign + "\", \"action\": \"Activate\", \"reason\": \"Automatic\" }")
+                , _pressure("{\"callsign\": \"" + callsign + "\", \"action\": \"MemoryPressure\", \"resident\": ")
+            {
+                for (uint8_t index = 0; index < REASONS; index++) {
+                    _reasons[index] = Name(static_cast<reason>(index));
+                    _deactivate[index] = "{\"callsign\": \"" + callsign + "\", \"action\": \"Deactivate\", \"reason\": \"" + _reasons[index] + "\" }";
+                    _markers[index] = callsign + ':' + _reasons[index];
+                }
+            }
+            ~Notices() = default;
+
+        public:
+            static string Name(const reason which)
+            {
+                switch (which) {
+                case MEMORY:
+                    return (Core::EnumerateType<PluginHost::IShell::reason>(PluginHost::IShell::MEMORY_EXCEEDED).Data());
+                case FAILURE:
+                    return (Core::EnumerateType<PluginHost::IShell::reason>(PluginHost::IShell::FAILURE).Data());
+                case BUDGET:
+                    return (_T("Budget"));
+                case UNRESPONSIVE:
+                    return (_T("Unresponsive"));
+                default:
+                    return (string());
+                }
+            }
+
+            inline const string& Reason(const reason which) const
+            {
+                return (_reasons[which]);
+            }
+            inline const string& Deactivate(const reason which) const
+            {
+                return (_deactivate[which]);
+            }
+            inline const string& Marker(const reason which) const
+            {
+                return (_markers[which]);
+            }
+            inline const string& Restart() const
+            {
+                return (_restart);
+            }
+            // Sizes in KiB.
+            string Pressure(const uint64_t resident, const uint64_t limit) const
+            {
+                string message;
+
+                message.reserve(_pressure.length() + 64);
+                message += _pressure;
+                message += std::to_string(resident);
+                message += ", \"limit\": ";
+                message += std::to_string(limit);
+                message += " }";
+
+                return (message);
+            }
+
+        private:
+            string _reasons[REASONS];
+            string _deactivate[REASONS];
+            string _markers[REASONS];
+            const string _restart;
+            const string _pressure;
+        };
+
+    private:
+        // What a probe got from the observable, taken in once the evaluation state is locked again. Sizes in bytes.
+        struct Reading {
+            bool Operational;
+            uint64_t Resident;
+            uint64_t Allocated;
+            uint64_t Shared;
+            uint64_t Processes;
+        };
+
+        class StateObserver : public Exchange::IStateControl::INotification {
+        public:
+            StateObserver() = delete;
+            StateObserver(const StateObserver&) = delete;
+            StateObserver& operator=(const StateObserver&) = delete;
+
+            explicit StateObserver(MonitorObject& parent)
+                : _parent(parent)
+            {
+            }
+            ~StateObserver() override = default;
+
+        public:
+            void StateChange(const Exchange::IStateControl::state state) override
+            {
+                _parent.Suspended(state == Exchange::IStateControl::SUSPENDED);
+            }
+
+            BEGIN_INTERFACE_MAP(StateObserver)
+            INTERFACE_ENTRY(Exchange::IStateControl::INotification)
+            END_INTERFACE_MAP
+
+        private:
+            MonitorObject& _parent;
+        };
+
+    public:
+PUSH_WARNING(DISABLE_WARNING_THIS_IN_MEMBER_INITIALIZER_LIST)
+        MonitorObject(const string& callsign, const Settings& settings, const uint64_t absTime)
+            : _operationalInterval(0)
+            , _memoryInterval(0)
+            , _adaptive(false)
+            , _cadence(settings.Memory, settings.Memory, settings.Memory)
+            , _sampling(0)
+            , _memoryThreshold(0)
+            , _memorySoftThreshold(0)
+            , _memoryGrace(NoGrace)
+            , _pressureSince(0)
+            , _memoryViolation()
+            , _operationalViolation()
+            , _hardBand()
+            , _softBand()
+            , _rearm(false)
+            , _operationalSlots(0)
+            , _memorySlots(0)
+            , _nextSlot(absTime)
+            , _restartWindow(0)
+            , _restarts()
+            , _restartLimit(0)
+            , _measurement()
+            , _operational(false)
+            , _operationalEvaluate(false)
+            , _source(nullptr)
+            , _interval(0)
+            , _active{ false }
+            , _failureMarker()
+            , _evaluateLatency()
+            , _ipcCalls(0)
+            , _probeTimeout(0)
+            , _probeStart(0)
+            , _probeTicket(0)
+            , _background(0)
+            , _nextBackground(0)
+            , _suspended(false)
+            , _shell(nullptr)
+            , _stateControl(nullptr)
+            , _attachment(0)
+            , _stateObserver(*this)
+            , _priority(0)
+            , _resident(0)
+            , _accounted(0)
+            , _victim(false)
+            , _claimed(false)
+            , _cgroup()
+            , _watch(-1)
+            , _nudged(0)
+            , _host(0)
+            , _breakdown(false)
+            , _tree()
+            , _roles()
+            , _culprits()
+            , _graphics(false)
+            , _graphicsThreshold(0)
+            , _graphicsViolation()
+            , _buffers()
+            , _settings(settings)
+            , _restartsSet(false)
+            , _reconfigure(false)
+            , _retired(false)
+            , _disposable(false)
+            , _pins(0)
+            , _generation(++Generations())
+            , _acquire(false)
+            , _activated(0)
+            , _arrival(0)
+            , _notices(callsign)
+            , _evaluateLock()
+            , _adminLock()
+        {
+            ASSERT((settings.Operational != 0) || (settings.Memory != 0));
+
+            Configure(settings, absTime);
+        }
+POP_WARNING()
+        ~MonitorObject()
+        {
+            Detach();
+
+            if (_source != nullptr) {
+                _source->Release();
+                _source = nullptr;
+            }
+        }
+
+        MonitorObject(MonitorObject&) = delete;
+        MonitorObject& operator=(MonitorObject&) = delete;
+        MonitorObject(MonitorObject&&) = delete;
+        MonitorObject& operator=(MonitorObject&&) = delete;
+
+    public:
+        inline bool RegisterRestart(PluginHost::IShell::reason why VARIABLE_IS_NOT_USED)
+        {
+            ASSERT(why == PluginHost::IShell::MEMORY_EXCEEDED || why == PluginHost::IShell::FAILURE);
+            ASSERT(HasRestartAllowed());
+
+            return (_restarts.Register(_restartLimit, _restartWindow, Clock::Now()));
+        }
+        inline uint8_t RestartLimit() const
+        {
+            return _restartLimit;
+        }
+        inline uint16_t RestartWindow() const
+        {
+            return _restartWindow;
+        }
+        // Kept in the settings as well, so new limits or intervals do not bring the configured ones back.
+        inline void UpdateRestartLimits(
+            const uint16_t restartWindow,
+            const uint8_t restartLimit)
+        {
+            _adminLock.Lock();
+            _settings.RestartWindow = restartWindow;
+            _settings.RestartLimit = restartLimit;
+            _restartsSet = true;
+            _adminLock.Unlock();
+
+            _restartWindow = restartWindow;
+            _restartLimit = restartLimit;
+            Changed();
+        }
+        // The settings a reload of the configuration asks for, with the restart limits set at runtime in them.
+        inline Settings Reloaded(Settings settings) const
+        {
+            Core::SafeSyncType<Core::CriticalSection> guard(_adminLock);
+
+            if (_restartsSet == true) {
+                settings.RestartWindow = _settings.RestartWindow;
+                settings.RestartLimit = _settings.RestartLimit;
+            }
+
+            return (settings);
+        }
+        // One counter for all observables, so a single number tells a poller what it has seen.
+        static std::atomic<uint64_t>& Generations()
+        {
+            static std::atomic<uint64_t> generations(0);
+            return (generations);
+        }
+        // Generation of the latest change to what status reports about the observable.
+        inline uint64_t Generation() const
+        {
+            return (_generation);
+        }
+        inline void Changed()
+        {
+            _generation = ++Generations();
+        }
+        inline bool HasRestartAllowed() const
+        {
+            return (_operationalEvaluate);
+        }
+        // The settings last asked for, applied or not.
+        inline Settings Configuration() const
+        {
+            Core::SafeSyncType<Core::CriticalSection> guard(_adminLock);
+            return (_settings);
+        }
+        // New settings for a live entry, the measurements are kept. Picked up by
+        // the job through Reconfigured, as that is where they are used.
+        inline void Reconfigure(const Settings& settings)
+        {
+            _adminLock.Lock();
+            _settings = settings;
+            _adminLock.Unlock();
+
+            _reconfigure = true;
+        }
+        // Applies pending settings, as long as no probe is running on them. True if it did.
+        bool Reconfigured(const uint64_t now)
+        {
+            bool result = false;
+
+            if ((_probeStart == 0) && (_reconfigure.exchange(false) == true)) {
+                Configure(Configuration(), now);
+                result = true;
+            }
+
+            return (result);
+        }
+        // Dropped from the configuration. Kept around till it let go of its plugin and no one holds on to it.
+        inline bool IsRetired() const
+        {
+            return (_retired);
+        }
+        inline void Retired(const bool retired)
+        {
+            _retired = retired;
+            _disposable = false;
+            Changed();
+        }
+        // Retired and released like a deactivated plugin, the job may erase it.
+        inline void Disposable()
+        {
+            _disposable = true;
+        }
+        inline bool IsDisposable() const
+        {
+            return ((_retired == true) && (_disposable == true) && (_pins == 0) && (_probeStart == 0));
+        }
+        // Held by whoever found the entry in the registry, see MonitorObjects::Entry.
+        inline void Pin()
+        {
+            _pins++;
+        }
+        inline void Unpin()
+        {
+            _pins--;
+        }
+        inline uint32_t Interval() const
+        {
+            return (_interval);
+        }
+        inline uint32_t Operational() const
+        {
+            return (_operational);
+        }
+        // A copy, the job keeps adding to the measurements once the lock is released.
+        inline MetaData Measurement() const
+        {
+            Core::SafeSyncType<Core::CriticalSection> guard(_adminLock);
+            return (_measurement);
+        }
+        // Of what a status reports only, so the lock is not held for what is left out.
+        inline MetaData Measurement(const Projection& projection) const
+        {
+            Core::SafeSyncType<Core::CriticalSection> guard(_adminLock);
+            return (MetaData(_measurement, projection));
+        }
+        // One metric only, where the rest of the measurements is not needed.
+        inline Core::MeasurementType<uint64_t> Lifetime(const Metrics::metric which) const
+        {
+            Core::SafeSyncType<Core::CriticalSection> guard(_adminLock);
+            return (_measurement.Lifetime(which));
+        }
+        inline uint64_t TimeSlot() const
+        {
+            return (_nextSlot);
+        }
+        inline void Reset()
+        {
+            Core::SafeSyncType<Core::CriticalSection> guard(_adminLock);
+            _measurement.Reset();
+            Changed();
+        }
+        inline void Retrigger(uint64_t currentSlot)
+        {
+            while (_nextSlot <= currentSlot) {
+                _nextSlot += _interval;
+            }
+        }
+        inline void Set(Exchange::IMemory* memory)
+        {
+            _adminLock.Lock();
+            if (_source != nullptr) {
+                _source->Release();
+                _source = nullptr;
+            }
+
+            if (memory != nullptr) {
+                _source = memory;
+                _source->AddRef();
+            }
+            _adminLock.Unlock();
+
+            _operational = (memory != nullptr);
+            _rearm = true;
+
+            if (memory == nullptr) {
+                _resident = 0;
+                _victim = false;
+                _claimed = false;
+            }
+        }
+
+        Core::ProxyType<const Exchange::IMemory> Source() const 
+        {
+            Core::ProxyType<const Exchange::IMemory> source;
+            _adminLock.Lock();
+            if(_source != nullptr) {
+                source = Core::ProxyType<const Exchange::IMemory>(*_source, *_source);
+            }
+            _adminLock.Unlock();
+            return source;
+        }
+
+        // Attach to a (re)activated instance. Its interfaces are only asked for by the
+        // first probe, see Acquire, so the lifecycle notification does not wait on it.
+        void Attach(PluginHost::IShell* shell)
+        {
+            Detach();
+
+            _adminLock.Lock();
+            _shell = shell;
+            _shell->AddRef();
+            _attachment++;
+            if (_probeStart == ABANDONED) {
+                // A probe of the previous instance that still hangs does not hold up
+                // the probes of this one, what it returns is dropped.
+                _probeStart = 0;
+                _probeTicket++;
+            }
+            _adminLock.Unlock();
+
+            _activated = Clock::Now();
+            _acquire = true;
+        }
+        // Picks up the memory and run state interfaces of a freshly attached instance.
+        // Dropped if the instance was detached while asking for them, even if the same
+        // shell was attached again since.
+        void Acquire()
+        {
+            if (_acquire.exchange(false) == true) {
+                _adminLock.Lock();
+                const uint32_t attachment = _attachment;
+                PluginHost::IShell* shell = _shell;
+                if (shell != nullptr) {
+                    shell->AddRef();
+                }
+                _adminLock.Unlock();
+
+                if (shell != nullptr) {
+                    _ipcCalls += 2;
+                    Exchange::IMemory* memory = shell->QueryInterface<Exchange::IMemory>();
+                    Exchange::IStateControl* stateControl = shell->QueryInterface<Exchange::IStateControl>();
+                    bool suspended = false;
+
+                    if (stateControl != nullptr) {
+                        _ipcCalls += 2;
+                        stateControl->Register(&_stateObserver);
+                        suspended = (stateControl->State() == Exchange::IStateControl::SUSPENDED);
+                    }
+
+                    _adminLock.Lock();
+                    if (_attachment == attachment) {
+                        ASSERT(_stateControl == nullptr);
+                        _stateControl = stateControl;
+                        stateControl = nullptr;
+                        _suspended = suspended;
+                        if (memory != nullptr) {
+                            Set(memory);
+                        }
+                    }
+                    _adminLock.Unlock();
+
+                    if (stateControl != nullptr) {
+                        stateControl->Unregister(&_stateObserver);
+                        stateControl->Release();
+                    }
+                    if (memory != nullptr) {
+                        memory->Release();
+                    }
+                    shell->Release();
+                }
+            }
+        }
+        void Detach()
+        {
+            _acquire = false;
+
+            _adminLock.Lock();
+            PluginHost::IShell* shell = _shell;
+            Exchange::IStateControl* stateControl = _stateControl;
+            _shell = nullptr;
+            _stateControl = nullptr;
+            _attachment++;
+            _adminLock.Unlock();
+
+            if (stateControl != nullptr) {
+                stateControl->Unregister(&_stateObserver);
+                stateControl->Release();
+            }
+            if (shell != nullptr) {
+                shell->Release();
+            }
+            _suspended = false;
+        }
+        inline void Suspended(const bool suspended)
+        {
+            _suspended = suspended;
+        }
+        inline bool IsSuspended() const
+        {
+            return (_suspended);
+        }
+        // The shell of the attached instance, with a reference for the caller, nullptr if there is none.
+        inline PluginHost::IShell* Shell() const
+        {
+            Core::SafeSyncType<Core::CriticalSection> guard(_adminLock);
+            if (_shell != nullptr) {
+                _shell->AddRef();
+            }
+            return (_shell);
+        }
+        inline const Notices& Notice() const
+        {
+            return (_notices);
+        }
+        // Whether this slot should reach out to the observable at all. A hibernated
+        // observable is frozen, a probe would only wake it up or hang, a suspended
+        // one is left alone apart from an occasional memory sample.
+        bool Probing(const uint64_t now)
+        {
+            bool result = true;
+
+            _adminLock.Lock();
+            const bool hibernated = ((_shell != nullptr) && (_shell->State() == PluginHost::IShell::HIBERNATED));
+            _adminLock.Unlock();
+
+            if (hibernated == true) {
+                result = false;
+            } else if (_suspended == true) {
+                if ((_background == 0) || (now < _nextBackground)) {
+                    result = false;
+                } else {
+                    _nextBackground = now + _background;
+                }
+            }
+
+            return (result);
+        }
+        // A ticket of 0 probes inline, on the job, the outcome of another one is only
+        // taken if it is still the latest probe of the observable when it returns.
+        inline uint32_t Probe(const uint32_t ticket = 0)
+        {
+            Acquire();
+
+            return (_suspended == true ? Sample(ticket) : Evaluate(ticket));
+        }
+        // Activation till the first probe that reached the instance, once per activation, 0 otherwise.
+        inline uint64_t Arrival()
+        {
+            return (_arrival.exchange(0));
+        }
+        // The evaluation state is locked before and after the calls into the observable,
+        // never across them, so a call that hangs holds up no one but its own probe.
+        inline uint32_t Evaluate(const uint32_t ticket)
+        {
+            const uint64_t start = Clock::Now();
+            Core::ProxyType<const Exchange::IMemory> source = Source();
+
+            uint32_t status(SUCCESFULL);
+            if (source.IsValid() == true) {
+                Reading reading = {};
+
+                _evaluateLock.Lock();
+
+                Rearm();
+                Arrived(start);
+
+                _operationalSlots -= _interval;
+                _memorySlots -= _interval;
+
+                const bool operational = ((_operationalInterval != 0) && (_operationalSlots == 0));
+                const bool memory = ((_memoryInterval != 0) && (_memorySlots == 0));
+
+                if (operational == true) {
+                    _operationalSlots = _operationalInterval;
+                }
+                if (memory == true) {
+                    _memorySlots = _sampling;
+                }
+
+                _evaluateLock.Unlock();
+
+                if (operational == true) {
+                    _ipcCalls++;
+                    reading.Operational = source->IsOperational();
+                }
+                if (memory == true) {
+                    Read(*source, reading);
+                }
+
+                _evaluateLock.Lock();
+
+                if (Current(ticket) == true) {
+                    if (operational == true) {
+                        _operational = reading.Operational;
+                        if (_operationalViolation.Set(reading.Operational == false, start) == true) {
+                            status |= NOT_OPERATIONAL;
+                            TRACE(Trace::Error, (_T("Status not operational. %d"), __LINE__));
+                        }
+                    }
+                    if (memory == true) {
+                        status |= Measure(reading, start);
+                    }
+                    if ((operational == true) || (memory == true)) {
+                        Changed();
+                    }
+                }
+
+                _evaluateLock.Unlock();
+
+                const uint64_t duration = Clock::Now() - start;
+                _adminLock.Lock();
+                _evaluateLatency.Set(duration);
+                _adminLock.Unlock();
+            }
+            return (status);
+        }
+        // Memory only, outside of the regular slots.
+        inline uint32_t Sample(const uint32_t ticket)
+        {
+            const uint64_t start = Clock::Now();
+            Core::ProxyType<const Exchange::IMemory> source = Source();
+
+            uint32_t status(SUCCESFULL);
+            if (source.IsValid() == true) {
+                Reading reading = {};
+
+                _evaluateLock.Lock();
+                const bool memory = (_memoryInterval != 0);
+                if (memory == true) {
+                    Rearm();
+                    Arrived(start);
+                }
+                _evaluateLock.Unlock();
+
+                if (memory == true) {
+                    Read(*source, reading);
+
+                    _evaluateLock.Lock();
+                    if (Current(ticket) == true) {
+                        status = Measure(reading, start);
+                        Changed();
+                    }
+                    _evaluateLock.Unlock();
+
+                    const uint64_t duration = Clock::Now() - start;
+                    _adminLock.Lock();
+                    _evaluateLatency.Set(duration);
+                    _adminLock.Unlock();
+                }
+            }
+            return (status);
+        }
+
+        bool IsActive() const { return _active; }
+        void Active(bool active) { _active = active; }
+
+        inline string FailureMarker() const
+        {
+            Core::SafeSyncType<Core::CriticalSection> guard(_adminLock);
+            return (_failureMarker);
+        }
+        inline Latency EvaluateLatency() const
+        {
+            Core::SafeSyncType<Core::CriticalSection> guard(_adminLock);
+            return (_evaluateLatency);
+        }
+        inline uint32_t IPCCalls() const
+        {
+            return (_ipcCalls);
+        }
+        inline void IPCCall()
+        {
+            _ipcCalls++;
+        }
+
+        inline uint64_t MemoryThreshold() const
+        {
+            return (_memoryThreshold);
+        }
+        inline uint64_t GraphicsThreshold() const
+        {
+            return (_graphicsThreshold);
+        }
+        // The group the process of the observable was moved into, if any. While it is, memory is read from there instead of over IPC.
+        inline void Confine(const std::shared_ptr<CGroup>& group, const int watch)
+        {
+            Core::SafeSyncType<Core::CriticalSection> guard(_adminLock);
+            _cgroup = group;
+            _watch = watch;
+        }
+        inline std::shared_ptr<CGroup> Group() const
+        {
+            Core::SafeSyncType<Core::CriticalSection> guard(_adminLock);
+            return (_cgroup);
+        }
+        inline int Watch() const
+        {
+            Core::SafeSyncType<Core::CriticalSection> guard(_adminLock);
+            return (_watch);
+        }
+        // Process id of the out of process host, 0 when running in process or not tracked.
+        inline void Host(const uint32_t pid)
+        {
+            _host = pid;
+        }
+        inline uint32_t Host() const
+        {
+            return (_host);
+        }
+        // The processes blamed by the latest sample, handed out once.
+        inline std::vector<ProcessRoles::Culprit> Culprits()
+        {
+            Core::SafeSyncType<Core::CriticalSection> guard(_adminLock);
+            std::vector<ProcessRoles::Culprit> result;
+            result.swap(_culprits);
+            return (result);
+        }
+        // The kernel may report reclaim many times a second, pass on one per memory interval.
+        inline bool Nudge(const uint64_t now)
+        {
+            const uint64_t quiet = std::max(static_cast<uint64_t>(_sampling), static_cast<uint64_t>(1000 * 1000));
+            uint64_t previous = _nudged;
+
+            return (((now - previous) >= quiet) && (_nudged.compare_exchange_strong(previous, now) == true));
+        }
+        inline uint8_t Priority() const
+        {
+            return (_priority);
+        }
+        // Latest resident size (bytes) of a running instance, 0 otherwise.
+        inline uint64_t Resident() const
+        {
+            return (_resident);
+        }
+        // What the resident size changed since the last call, to keep a sum up to date without walking all entries.
+        inline uint64_t Settle()
+        {
+            const uint64_t resident = _resident;
+            return (resident - _accounted.exchange(resident));
+        }
+        inline bool IsVictim() const
+        {
+            return (_victim);
+        }
+        inline void Victim()
+        {
+            _victim = true;
+        }
+        // Taken by whoever deactivates the observable, before anything is reported, so a violation
+        // seen at the same time by the job, a probe thread and the cgroup events is acted on once.
+        // Let go of once the instance is gone, or if it could not be deactivated.
+        inline bool Claim()
+        {
+            bool idle = false;
+            return (_claimed.compare_exchange_strong(idle, true));
+        }
+        inline void Unclaim()
+        {
+            _claimed = false;
+        }
+        inline bool IsClaimed() const
+        {
+            return (_claimed);
+        }
+        inline uint32_t MemoryInterval() const
+        {
+            return (_sampling);
+        }
+        inline uint64_t MemorySoftThreshold() const
+        {
+            return (_memorySoftThreshold);
+        }
+        // From where memory pressure is signalled, in bytes: the soft limit, or a tenth below the limit
+        // without one. The memory.high of a confined observable, so pressure is reported against it.
+        inline uint64_t PressureThreshold() const
+        {
+            const uint64_t soft(_memorySoftThreshold);
+            const uint64_t max(_memoryThreshold);
+
+            return (soft != 0 ? soft : (max - (max / 10)));
+        }
+
+        inline uint64_t ProbeTimeout() const
+        {
+            return (_probeTimeout);
+        }
+        inline uint64_t ProbeStarted() const
+        {
+            return (_probeStart);
+        }
+        // Only one probe per observable is in flight, a slot that comes up while it is, is skipped.
+        // The ticket tells the probe apart from the ones before it.
+        inline bool ProbeStart(const uint64_t now, uint32_t& ticket)
+        {
+            Core::SafeSyncType<Core::CriticalSection> guard(_adminLock);
+            const bool result = (_probeStart == 0);
+
+            if (result == true) {
+                _probeStart = now;
+                if (++_probeTicket == 0) {
+                    ++_probeTicket;
+                }
+                ticket = _probeTicket;
+            }
+
+            return (result);
+        }
+        // The probe did not make it in time, true if it is the caller that gave up on it.
+        inline bool ProbeAbandon(const uint64_t started)
+        {
+            Core::SafeSyncType<Core::CriticalSection> guard(_adminLock);
+            const bool result = ((started != 0) && (started != ABANDONED) && (_probeStart == started));
+
+            if (result == true) {
+                _probeStart = ABANDONED;
+            }
+
+            return (result);
+        }
+        // The probe returned, false if its outcome has been superseded by the timeout or a new instance.
+        inline bool ProbeEnd(const uint32_t ticket)
+        {
+            Core::SafeSyncType<Core::CriticalSection> guard(_adminLock);
+            bool result = false;
+
+            if (ticket == _probeTicket) {
+                result = (_probeStart != ABANDONED);
+                _probeStart = 0;
+            }
+
+            return (result);
+        }
+
+    private:
+        // Only from the constructor or the job, the filters and slots start afresh.
+        void Configure(const Settings& settings, const uint64_t now)
+        {
+            _evaluateLock.Lock();
+
+            _operationalEvaluate = settings.ActOnOperational;
+            _operationalInterval = settings.Operational;
+            _memoryInterval = settings.Memory;
+            _adaptive = ((settings.Memory != 0) && (settings.MemoryMin < settings.MemoryMax));
+            _cadence = Cadence(_adaptive ? settings.MemoryMin : settings.Memory, _adaptive ? settings.MemoryMax : settings.Memory, settings.Memory);
+            _sampling = (_adaptive ? _cadence.Interval() : settings.Memory);
+            _memoryThreshold = settings.Threshold * 1024;
+            _memorySoftThreshold = settings.SoftThreshold * 1024;
+            _memoryGrace = settings.Grace;
+            _pressureSince = 0;
+            _memoryViolation = settings.Rule;
+            _operationalViolation = settings.Rule;
+            _hardBand = Hysteresis(settings.Clearance);
+            _softBand = Hysteresis(settings.Clearance);
+            _operationalSlots = _operationalInterval;
+            _memorySlots = _sampling;
+            _interval = gcd(_operationalInterval, (_adaptive ? _cadence.Min() : _memoryInterval));
+            _nextSlot = now;
+            _restartWindow = settings.RestartWindow;
+            _restartLimit = settings.RestartLimit;
+            _probeTimeout = settings.ProbeTimeout;
+            _background = settings.Background;
+            _nextBackground = 0;
+            _priority = settings.Priority;
+            _breakdown = ((settings.Breakdown == true) || (settings.Roles.empty() == false));
+            _roles.Configure(settings.Roles, settings.Rule);
+            _graphics = ((settings.Graphics == true) || (settings.GraphicsThreshold != 0));
+            _graphicsThreshold = settings.GraphicsThreshold * 1024;
+            _graphicsViolation = settings.Rule;
+
+            _evaluateLock.Unlock();
+
+            _adminLock.Lock();
+            _failureMarker = settings.FailureMarker;
+            _adminLock.Unlock();
+        }
+        inline void Arrived(const uint64_t now)
+        {
+            const uint64_t activated = _activated.exchange(0);
+
+            if (activated != 0) {
+                _arrival = now - activated;
+            }
+        }
+        // With the evaluation state locked, whether the outcome of a probe still counts.
+        inline bool Current(const uint32_t ticket) const
+        {
+            return ((ticket == 0) || (ticket == _probeTicket));
+        }
+        inline void Rearm()
+        {
+            if (_rearm.exchange(false) == true) {
+                // A new instance, what the previous one did should not count against it.
+                _memoryViolation.Reset();
+                _operationalViolation.Reset();
+                _hardBand.Reset();
+                _softBand.Reset();
+                _cadence.Reset();
+                _roles.Reset();
+                _graphicsViolation.Reset();
+                _pressureSince = 0;
+            }
+        }
+        // Without the evaluation state locked, the sizes come over IPC unless the observable is confined.
+        void Read(const Exchange::IMemory& source, Reading& reading)
+        {
+            const std::shared_ptr<CGroup> group(Group());
+
+            if (group != nullptr) {
+                const CGroup::Usage usage(group->Current());
+                // Not memory.current, the page cache it holds is no part of a resident size.
+                reading.Resident = usage.Resident();
+                reading.Allocated = usage.Anonymous;
+                reading.Shared = usage.Shared;
+                reading.Processes = usage.Processes;
+            } else {
+                _ipcCalls += 4;
+                reading.Resident = source.Resident();
+                reading.Allocated = source.Allocated();
+                reading.Shared = source.Shared();
+                reading.Processes = source.Processes();
+            }
+        }
+        // With the evaluation state locked, the breakdown and the dma-buf accounting carry state from sample to sample.
+        uint32_t Measure(const Reading& reading, const uint64_t start)
+        {
+            uint32_t status(SUCCESFULL);
+            const uint64_t resident(reading.Resident);
+
+            _adminLock.Lock();
+            _measurement.AddMeasurements(resident, reading.Allocated, reading.Shared, reading.Processes);
+            _adminLock.Unlock();
+
+            _resident = resident;
+
+            if ((_memoryThreshold != 0) && (_memoryViolation.Set(_hardBand.Above(resident, _memoryThreshold), start) == true)) {
+                status |= EXCEEDED_MEMORY;
+                TRACE(Trace::Error, (_T("Status MetaData Exceeded. %d"), __LINE__));
+            } else if ((_memorySoftThreshold != 0) && (_softBand.Above(resident, _memorySoftThreshold) == true)) {
+                if (_pressureSince == 0) {
+                    // Crossed the soft limit, nudge the observable once and give it the grace period to recover.
+                    _pressureSince = start;
+                    status |= MEMORY_PRESSURE;
+                    TRACE(Trace::Warning, (_T("Status MetaData under pressure. %d"), __LINE__));
+                } else if ((_memoryGrace != NoGrace) && ((start - _pressureSince) >= _memoryGrace)) {
+                    status |= EXCEEDED_MEMORY;
+                    TRACE(Trace::Error, (_T("Status MetaData above soft limit beyond grace period. %d"), __LINE__));
+                }
+            } else {
+                _pressureSince = 0;
+            }
+
+            if ((_breakdown == true) && (_host != 0)) {
+                const std::vector<ProcessTree::Process> processes(_tree.Walk(_host));
+                std::vector<ProcessRoles::Culprit> culprits(_roles.Check(processes, start));
+
+                _adminLock.Lock();
+                _measurement.AddProcesses(processes);
+                _adminLock.Unlock();
+
+                for (const ProcessRoles::Culprit& culprit : culprits) {
+                    status |= (culprit.Narrow == true ? EXCEEDED_PROCESS : EXCEEDED_MEMORY);
+                    TRACE(Trace::Error, (_T("Status MetaData of %s (%u) Exceeded. %d"), culprit.Role.c_str(), culprit.Pid, __LINE__));
+                }
+
+                if (culprits.empty() == false) {
+                    _adminLock.Lock();
+                    _culprits = std::move(culprits);
+                    _adminLock.Unlock();
+                }
+            }
+
+            if ((_graphics == true) && (_host != 0)) {
+                const uint64_t graphics(_buffers.Measure(_tree.Pids(_host)));
+
+                _adminLock.Lock();
+                _measurement.Add(Metrics::DMABUF, graphics, start);
+                _adminLock.Unlock();
+
+                if ((_graphicsThreshold != 0) && (_graphicsViolation.Set(graphics > _graphicsThreshold, start) == true)) {
+                    status |= (EXCEEDED_MEMORY | EXCEEDED_GRAPHICS);
+                    TRACE(Trace::Error, (_T("Status dma-buf MetaData Exceeded. %d"), __LINE__));
+                }
+            }
+
+            if (_adaptive == true) {
+                // Sample the sooner the closer it gets to the first limit it would run into.
+                const uint64_t limit = (((_memorySoftThreshold != 0) && ((_memoryThreshold == 0) || (_memorySoftThreshold < _memoryThreshold))) ? _memorySoftThreshold : _memoryThreshold);
+                _sampling = _cadence.Set(resident, limit);
+            }
+
+            return (status);
+        }
+
+    private:
+        // The evaluation state is only touched by the probe that evaluates, on the job or on a probe
+        // thread, and by Configure on the job, both with _evaluateLock taken. A probe of a previous
+        // instance that still hangs takes it as well once it returns, only to find it is not current.
+        uint32_t _operationalInterval; //!< Interval (us) to check the monitored processes, under _evaluateLock.
+        uint32_t _memoryInterval; //!< Interval (us) for a memory measurement, under _evaluateLock.
+        bool _adaptive; // under _evaluateLock
+        Cadence _cadence; // under _evaluateLock
+        std::atomic<uint32_t> _sampling; //!< Current memory interval (us), the configured one unless adaptive.
+        std::atomic<uint64_t> _memoryThreshold; //!< MetaData threshold in bytes for all processes.
+        std::atomic<uint64_t> _memorySoftThreshold; //!< MetaData threshold in bytes from where memory pressure is signalled.
+        uint64_t _memoryGrace; //!< MicroSeconds allowed above the soft threshold, NoGrace for no limit. Under _evaluateLock.
+        uint64_t _pressureSince; // under _evaluateLock
+        Violation _memoryViolation; // under _evaluateLock
+        Violation _operationalViolation; // under _evaluateLock
+        Hysteresis _hardBand; // under _evaluateLock
+        Hysteresis _softBand; // under _evaluateLock
+        std::atomic<bool> _rearm; // no ordering needed, atomic should suffice
+        uint32_t _operationalSlots; // under _evaluateLock
+        uint32_t _memorySlots; // under _evaluateLock
+        std::atomic<uint64_t> _nextSlot; // no ordering needed, atomic should suffice
+        std::atomic<uint16_t> _restartWindow; // no ordering needed, atomic should suffice
+        Restarts _restarts; // only used from the lifecycle notifications, no protection needed
+        std::atomic<uint8_t> _restartLimit;  // no ordering needed, atomic should suffice
+        MetaData _measurement;
+        std::atomic<bool> _operational; // no ordering needed, atomic should suffice
+        std::atomic<bool> _operationalEvaluate; // no ordering needed, atomic should suffice
+        Exchange::IMemory* _source;
+        uint32_t _interval; //!< The greatest possible interval to check both memory and processes. Written under _evaluateLock, on the job.
+        std::atomic<bool> _active;
+        string _failureMarker;
+        Latency _evaluateLatency;
+        std::atomic<uint32_t> _ipcCalls; // no ordering needed, atomic should suffice
+        uint64_t _probeTimeout; //!< MicroSeconds, 0 evaluates inline in the job.
+        std::atomic<uint64_t> _probeStart; //!< Start of the probe in flight, changed under _adminLock, read without it.
+        std::atomic<uint32_t> _probeTicket; //!< Of the latest probe in flight, changed under _adminLock.
+        uint64_t _background; //!< MicroSeconds between memory samples while suspended, 0 for none.
+        uint64_t _nextBackground; // does not need protection, only touched in job (Probing)
+        std::atomic<bool> _suspended; // no ordering needed, atomic should suffice
+        PluginHost::IShell* _shell;
+        Exchange::IStateControl* _stateControl;
+        uint32_t _attachment; //!< Moves on with every attach and detach, so a late Acquire knows its instance is gone.
+        Core::Sink<StateObserver> _stateObserver;
+        std::atomic<uint8_t> _priority; // no ordering needed, atomic should suffice
+        std::atomic<uint64_t> _resident; // no ordering needed, atomic should suffice
+        std::atomic<uint64_t> _accounted; //!< Part of the resident size that made it into the budget sum.
+        std::atomic<bool> _victim; //!< Shut down to stay within the budget, no longer counted.
+        std::atomic<bool> _claimed; //!< A deactivation is on its way, see Claim.
+        std::shared_ptr<CGroup> _cgroup;
+        int _watch;
+        std::atomic<uint64_t> _nudged; //!< Last memory pressure raised from the cgroup events.
+        std::atomic<uint32_t> _host; // no ordering needed, atomic should suffice
+        bool _breakdown; // under _evaluateLock
+        ProcessTree _tree; // no state of its own
+        ProcessRoles _roles; // under _evaluateLock
+        std::vector<ProcessRoles::Culprit> _culprits; //!< Blamed by the latest sample, till Enforce picks them up.
+        bool _graphics; // under _evaluateLock
+        std::atomic<uint64_t> _graphicsThreshold; //!< dma-buf threshold in bytes, 0 for no limit.
+        Violation _graphicsViolation; // under _evaluateLock
+        DmaBuf _buffers; // under _evaluateLock
+        Settings _settings;
+        bool _restartsSet; //!< The restart limits in _settings were set at runtime.
+        std::atomic<bool> _reconfigure; //!< _settings changed, the job did not apply them yet.
+        std::atomic<bool> _retired; // no ordering needed, atomic should suffice
+        std::atomic<bool> _disposable; //!< Retired and released, see Disposable.
+        std::atomic<uint32_t> _pins; //!< Handed out by Find and not let go of yet, taken under the registry lock.
+        std::atomic<uint64_t> _generation; // no ordering needed, atomic should suffice
+        std::atomic<bool> _acquire; //!< Attached, the interfaces still have to be acquired.
+        std::atomic<uint64_t> _activated; //!< Attached at, till the first probe reached it.
+        std::atomic<uint64_t> _arrival;
+        const Notices _notices;
+        Core::CriticalSection _evaluateLock; //!< Never held across a call into the observable.
+        mutable Core::CriticalSection _adminLock;
+    };
+
+} // namespace Plugin
+} // namespace WPEFramework
+
+#endif // __MONITOR_OBJECT_H
@@ -0,0 +1,1089 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Module.h"
+#include "Monitor.h"
+
+namespace WPEFramework {
+namespace Plugin {
+
+    uint32_t Monitor::MonitorObjects::Limits(const string& observable, const LimitsInfo& limits, LimitsInfo& result)
+    {
+        uint32_t error = Core::ERROR_UNKNOWN_KEY;
+
+        _registryLock.Lock();
+
+        const Entry info(Find(observable));
+
+        if ((info.IsValid() == true) && (info->IsRetired() == false)) {
+            MonitorObject::Settings settings(info->Configuration());
+
+            error = Core::ERROR_BAD_REQUEST;
+
+            if (((limits.MetaData.IsSet() == false) || (limits.MetaData.Value() <= MonitorObject::MaxInterval))
+                && ((limits.Operational.IsSet() == false) || (Seconds(limits.Operational.Value()) <= MonitorObject::MaxInterval))) {
+
+                if (limits.MetaData.IsSet() == true) {
+                    const uint32_t memory(Interval(limits.MetaData.Value()));
+
+                    // Adaptive bounds are kept, otherwise they follow the interval.
+                    if (settings.MemoryMin >= settings.MemoryMax) {
+                        settings.MemoryMin = memory;
+                        settings.MemoryMax = memory;
+                    }
+                    settings.Memory = memory;
+                }
+                if (limits.Operational.IsSet() == true) {
+                    settings.ActOnOperational = (limits.Operational.Value() >= 0);
+                    settings.Operational = Interval(Seconds(limits.Operational.Value()));
+                }
+                if (limits.MetaDataLimit.IsSet() == true) {
+                    settings.Threshold = limits.MetaDataLimit.Value();
+                }
+                if (limits.MetaDataSoftLimit.IsSet() == true) {
+                    settings.SoftThreshold = limits.MetaDataSoftLimit.Value();
+                }
+
+                // Something is watched, and pressure is signalled before the limit is hit.
+                if (((settings.Operational != 0) || (settings.Memory != 0)) && ((settings.Threshold == 0) || (settings.SoftThreshold < settings.Threshold))) {
+                    if (settings != info->Configuration()) {
+                        info->Reconfigure(settings);
+                    }
+
+                    result.MetaData = settings.Memory / (1000 * 1000);
+                    result.MetaDataLimit = static_cast<uint32_t>(settings.Threshold);
+                    result.MetaDataSoftLimit = static_cast<uint32_t>(settings.SoftThreshold);
+                    result.Operational = static_cast<int32_t>(settings.Operational / (1000 * 1000)) * (settings.ActOnOperational == true ? 1 : -1);
+
+                    error = Core::ERROR_NONE;
+                }
+            }
+        }
+
+        _registryLock.Unlock();
+
+        if (error == Core::ERROR_NONE) {
+            Replan();
+        }
+
+        return (error);
+    }
+
+    void Monitor::MonitorObjects::Open(PluginHost::IShell* service, Config& config)
+    {
+        ASSERT((service != nullptr) && (_service == nullptr));
+
+        Core::JSON::ArrayType<Config::Entry>::Iterator index(config.Observables.Elements());
+        const Config::Reporting& telemetry(config.Telemetry);
+        const Config::Allocation& budget(config.Budget);
+
+        uint64_t baseTime = Clock::Now();
+
+        // Generations go on from the wall clock (MicroSeconds), so they still grow when the Monitor comes back.
+        const uint64_t epoch = Core::Time::Now().Ticks();
+        if (MonitorObject::Generations() < epoch) {
+            MonitorObject::Generations() = epoch;
+        }
+
+        _service = service;
+        _service->AddRef();
+
+        _markers.Deactivate = (telemetry.Deactivate.IsSet() == true ? telemetry.Deactivate.Value() : string(_T("SYST_INFO_MonitorDeactivate")));
+        _markers.Restart = (telemetry.Restart.IsSet() == true ? telemetry.Restart.Value() : string(_T("SYST_INFO_MonitorRestart")));
+        _markers.GiveUp = (telemetry.GiveUp.IsSet() == true ? telemetry.GiveUp.Value() : string(_T("SYST_INFO_MonitorGiveUp")));
+        _markers.Memory = (telemetry.Memory.IsSet() == true ? telemetry.Memory.Value() : string(_T("SYST_INFO_MonitorMemory")));
+        _markers.Pressure = (telemetry.Pressure.IsSet() == true ? telemetry.Pressure.Value() : string(_T("SYST_INFO_MonitorMemoryPressure")));
+        _summaryInterval = static_cast<uint64_t>(telemetry.Summary.Value()) * 1000 * 1000; // Move from Seconds to MicroSeconds
+        _nextSummary = baseTime + _summaryInterval;
+        _telemetry.Open(telemetry.Interval.Value());
+        _probes.Open(ProbeThreads, SpareProbeThreads);
+
+        _budget = static_cast<uint64_t>(budget.Limit.Value()) * 1024;
+        _largestFirst = (budget.Policy.Value() == _T("largest"));
+        _aggregate = 0;
+
+        // Sized once, records are written without allocating from here on.
+        _recorder.Open(config.Records.Size.Value());
+        _dumpFile = (config.Records.Dump.IsSet() == true ? config.Records.Dump.Value() : _service->VolatilePath() + _T("MonitorRecorder.json"));
+        _dumper = Core::ProxyType<Core::IDispatch>(Core::ProxyType<DumpJob>::Create(*this));
+
+        if (config.Diagnosis.Directory.Value().empty() == false) {
+            if (_archive.Open(config.Diagnosis.Directory.Value(), static_cast<uint64_t>(config.Diagnosis.Size.Value()) * 1024) == true) {
+                _captureBudget = static_cast<uint64_t>(config.Diagnosis.Budget.Value()) * 1000; // Move from MilliSeconds to MicroSeconds
+                _archiver = Core::ProxyType<Core::IDispatch>(Core::ProxyType<ArchiveJob>::Create(*this));
+            } else {
+                SYSLOG(Logging::Startup, (_T("Could not create %s, no diagnostics are captured."), config.Diagnosis.Directory.Value().c_str()));
+            }
+        }
+
+        while (index.Next() == true) {
+            const Config::Entry& element(index.Current());
+            const string callSign(element.Callsign.Value());
+            const MonitorObject::Settings settings(Configuration(element));
+
+            SYSLOG(Logging::Startup, (_T("Monitoring: %s (%d,%d)."), callSign.c_str(), (settings.Operational / 1000000), (settings.Memory / 1000000)));
+            if ((settings.Operational != 0) || (settings.Memory != 0)) {
+                Insert(callSign, settings, baseTime);
+            }
+        }
+
+        if (config.CGroups.Root.Value().empty() == false) {
+            if ((_containment.IsValid() == true) && (CGroup::Enable(config.CGroups.Root.Value()) == true)) {
+                _cgroupRoot = config.CGroups.Root.Value();
+                Core::ResourceMonitor::Instance().Register(_containment);
+            } else {
+                SYSLOG(Logging::Startup, (_T("No cgroup v2 memory controller at %s, observables are not confined."), config.CGroups.Root.Value().c_str()));
+            }
+        }
+
+        // Host processes are tracked for the cgroups, the diagnostics and the breakdown.
+        // Reports the processes already running as well.
+        _service->Register(&_connections);
+
+        // The job is started by the first observable that is activated, nothing to probe till then.
+
+        _overheadLock.Lock();
+        _startup = Clock::Now() - baseTime;
+        _overheadLock.Unlock();
+    }
+
+    void Monitor::MonitorObjects::Close()
+    {
+        ASSERT(_service != nullptr);
+
+        _service->Unregister(&_connections);
+
+        // First, the job is the one that erases entries.
+        _job.Revoke();
+
+        if (_cgroupRoot.empty() == false) {
+            Core::ResourceMonitor::Instance().Unregister(_containment);
+
+            // Taken under the registry lock, a reload may still add entries.
+            for (MonitorObjectContainer::value_type* element : Registry()) {
+                Release(element->first);
+            }
+            _cgroupRoot.clear();
+        }
+
+        // Probes that did not start yet are dropped, the ones that run are waited for:
+        // nothing they run may outlive the plugin. A probe that hangs holds up the
+        // shutdown till its call returns, which it does once the observable it is
+        // stuck in is gone, the timeout took care of shutting that one down.
+        _probes.Close();
+
+        _telemetry.Close();
+
+        Core::IWorkerPool::Instance().Revoke(_dumper);
+        _dumper.Release();
+
+        if (_archiver.IsValid() == true) {
+            Core::IWorkerPool::Instance().Revoke(_archiver);
+            _archiver.Release();
+            _captures.clear();
+            _archive.Open(string(), 0);
+        }
+
+        _registryLock.Lock();
+        _monitor.clear();
+        _registryLock.Unlock();
+
+        _service->Release();
+        _service = nullptr;
+    }
+
+    void Monitor::MonitorObjects::Reload(const Core::JSON::ArrayType<Config::Entry>& observables, ReloadInfo& report)
+    {
+        const uint64_t now = Clock::Now();
+        std::map<string, MonitorObject::Settings> wanted;
+        std::list<string> added;
+        std::list<string> removed;
+
+        Core::JSON::ArrayType<Config::Entry>::ConstIterator index(observables.Elements());
+
+        while (index.Next() == true) {
+            const Config::Entry& element(index.Current());
+            const MonitorObject::Settings settings(Configuration(element));
+
+            if ((settings.Operational != 0) || (settings.Memory != 0)) {
+                wanted.emplace(element.Callsign.Value(), settings);
+            }
+        }
+
+        _registryLock.Lock();
+
+        for (auto& element : _monitor) {
+            if ((element.second.IsRetired() == false) && (wanted.find(element.first) == wanted.end())) {
+                element.second.Retired(true);
+                removed.push_back(element.first);
+            }
+        }
+
+        for (const auto& entry : wanted) {
+            MonitorObjectContainer::iterator element(_monitor.find(entry.first));
+
+            if (element == _monitor.end()) {
+                Insert(entry.first, entry.second, now);
+                added.push_back(entry.first);
+            } else if (element->second.IsRetired() == true) {
+                // Back after being dropped, it starts with a clean slate.
+                element->second.Reconfigure(element->second.Reloaded(entry.second));
+                element->second.Reset();
+                element->second.Retired(false);
+                added.push_back(entry.first);
+            } else {
+                const MonitorObject::Settings settings(element->second.Reloaded(entry.second));
+
+                if (element->second.Configuration() != settings) {
+                    element->second.Reconfigure(settings);
+                    report.Updated.Add() = entry.first;
+                }
+            }
+        }
+
+        _registryLock.Unlock();
+
+        for (const string& callsign : removed) {
+            Retire(callsign);
+            report.Removed.Add() = callsign;
+            SYSLOG(Logging::Notification, (_T("No longer monitoring: %s."), callsign.c_str()));
+        }
+
+        for (const string& callsign : added) {
+            report.Added.Add() = callsign;
+            SYSLOG(Logging::Notification, (_T("Monitoring: %s."), callsign.c_str()));
+
+            // Already running plugins were reported when the notifications were registered, these missed it.
+            _ipcCalls++;
+            PluginHost::IShell* plugin(_service->QueryInterfaceByCallsign<PluginHost::IShell>(callsign));
+
+            if (plugin != nullptr) {
+                if (plugin->State() == PluginHost::IShell::ACTIVATED) {
+                    Activated(callsign, plugin);
+                }
+                plugin->Release();
+            }
+        }
+
+        Replan();
+    }
+
+    void Monitor::MonitorObjects::Activated(const string& callsign, PluginHost::IShell* service)
+    {
+        const uint64_t start = Clock::Now();
+        const Entry info(Find(callsign));
+
+        if ((info.IsValid() == true) && (info->IsRetired() == false)) {
+
+            info->Active(true);
+
+            // The MetaData interface is asked for by the first probe, from the job.
+            info->Attach(service);
+
+            if (_job.Submit() == true) {
+                TRACE(Trace::Information, (_T("Starting to probe as active observee appeared.")));
+            }
+
+        } 
+
+        Notified(Clock::Now() - start);
+    }
+
+    void Monitor::MonitorObjects::Deactivated(const string& callsign, PluginHost::IShell* service)
+    {
+        const uint64_t start = Clock::Now();
+        const Entry info(Find(callsign));
+
+        if ((info.IsValid() == true) && (info->IsRetired() == false)) {
+            // Off its state notifications while its implementation is still there to take them back.
+            info->Detach();
+        }
+
+        Notified(Clock::Now() - start);
+    }
+
+    void Monitor::MonitorObjects::Deinitialized(const string& callsign, PluginHost::IShell* service)
+    {
+        const uint64_t start = Clock::Now();
+        const Entry info(Find(callsign));
+
+        if ((info.IsValid() == true) && (info->IsRetired() == false)) {
+
+            // Normally detached in Deactivated already, nothing is left to drop then.
+            info->Detach();
+            info->Set(nullptr);
+            info->Active(false);
+            _aggregate += info->Settle();
+
+            PluginHost::IShell::reason reason = service->Reason();
+
+            if ((info->HasRestartAllowed() == true) && ((reason == PluginHost::IShell::MEMORY_EXCEEDED) || (reason == PluginHost::IShell::FAILURE))) {
+                if (info->RegisterRestart(reason) == false) {
+                    uint8_t restartlimit = info->RestartLimit();
+                    uint16_t restartwindow = info->RestartWindow();
+                    TRACE(Trace::Fatal, (_T("Giving up restarting of %s: Failed more than %d times within %d seconds."), callsign.c_str(), restartlimit, restartwindow));
+                    const string message("{\"callsign\": \"" + callsign + "\", \"action\": \"Restart\", \"reason\":\"" + (std::to_string(restartlimit)).c_str() + " Attempts Failed within the restart window\"}");
+                    _service->Notify(message);
+                    _parent.event_action(callsign, "StoppedRestaring", std::to_string(info->RestartLimit()) + " attempts failed within the restart window");
+                    _telemetry.Event(_markers.GiveUp, callsign);
+                    _recorder.Write(Recorder::GIVEUP, callsign, restartlimit, restartwindow, 0);
+
+                    // What led up to it is on file before it is overwritten.
+                    if (_dumping.exchange(true) == false) {
+                        Core::IWorkerPool::Instance().Submit(_dumper);
+                    }
+                } else {
+                    _service->Notify(info->Notice().Restart());
+                    _parent.event_action(callsign, "Activate", "Automatic");
+                    _telemetry.Event(_markers.Restart, callsign);
+                    _recorder.Write(Recorder::RESTART, callsign, 0, 0, 0);
+                    TRACE(Trace::Error, (_T("Restarting %s again because we detected it misbehaved."), callsign.c_str()));
+                    Core::IWorkerPool::Instance().Submit(PluginHost::IShell::Job::Create(service, PluginHost::IShell::ACTIVATED, PluginHost::IShell::AUTOMATIC));
+                }
+            } 
+        }
+
+        Notified(Clock::Now() - start);
+    }
+
+    void Monitor::MonitorObjects::Snapshot(Core::JSON::ArrayType<Monitor::Data>& snapshot, const std::vector<string>& callsigns, const Projection& projection) const
+    {
+        Core::SafeSyncType<Core::CriticalSection> guard(_registryLock);
+
+        if (callsigns.empty() == false) {
+            for (const string& callsign : callsigns) {
+                MonitorObjectContainer::const_iterator element(_monitor.find(callsign));
+
+                if ((element != _monitor.cend()) && (element->second.IsRetired() == false)) {
+                    const MetaData data(element->second.Measurement(projection));
+
+                    if (data.HasMeasurements() == true) {
+                        snapshot.Add(Monitor::Data(element->first, data, element->second.Operational(), projection, element->second.Generation()));
+                    }
+                }
+            }
+        } else {
+            MonitorObjectContainer::const_iterator element(_monitor.cbegin());
+
+            // Go through the list of observations...
+            while (element != _monitor.cend()) {
+                if (element->second.IsRetired() == false) {
+                    const MetaData data(element->second.Measurement(projection));
+
+                    if (data.HasMeasurements() == true) {
+                        snapshot.Add(Monitor::Data(element->first, data, element->second.Operational(), projection, element->second.Generation()));
+                    }
+                }
+                element++;
+            }
+        }
+    }
+
+    bool Monitor::MonitorObjects::Snapshot(const string& name, const Projection& projection, Monitor::MetaData& result, bool& operational, uint64_t& generation) const
+    {
+        bool found = false;
+
+        Core::SafeSyncType<Core::CriticalSection> guard(_registryLock);
+
+        MonitorObjectContainer::const_iterator index(_monitor.find(name));
+
+        if ((index != _monitor.cend()) && (index->second.IsRetired() == false)) {
+            const MetaData data(index->second.Measurement(projection));
+            if (data.HasMeasurements() == true) {
+                result = data;
+                operational = index->second.Operational();
+                generation = index->second.Generation();
+                found = true;
+            }
+        }
+
+        return (found);
+    }
+
+    void Monitor::MonitorObjects::Snapshot(const std::vector<string>& callsigns, const Projection& projection, Core::JSON::ArrayType<Monitor::Info>* response) const
+    {
+
+        ASSERT(response != nullptr);
+
+        Core::SafeSyncType<Core::CriticalSection> guard(_registryLock);
+
+        if (callsigns.empty() == false) {
+            for (const string& callsign : callsigns) {
+                auto element = _monitor.find(callsign);
+                if ((element != _monitor.end()) && (element->second.IsRetired() == false) && (element->second.Generation() > projection.Since())) {
+                    AddElementToRespone(*response, element->first, element->second, projection);
+                }
+            }
+        } else {
+            for (auto& element : _monitor) {
+                if ((element.second.IsRetired() == false) && (element.second.Generation() > projection.Since())) {
+                    AddElementToRespone(*response, element.first, element.second, projection);
+                }
+            }
+        }
+    }
+
+    uint64_t Monitor::MonitorObjects::Generation(const std::vector<string>& callsigns) const
+    {
+        uint64_t result = 0;
+
+        if (callsigns.empty() == true) {
+            result = MonitorObject::Generations();
+        } else {
+            Core::SafeSyncType<Core::CriticalSection> guard(_registryLock);
+
+            for (const string& callsign : callsigns) {
+                MonitorObjectContainer::const_iterator element(_monitor.find(callsign));
+
+                if ((element != _monitor.cend()) && (element->second.Generation() > result)) {
+                    result = element->second.Generation();
+                }
+            }
+        }
+
+        return (result);
+    }
+
+    void Monitor::MonitorObjects::Overhead(SelfInfo& response) const
+    {
+        uint32_t ipcCalls = _ipcCalls;
+
+        Core::SafeSyncType<Core::CriticalSection> guard(_registryLock);
+
+        for (const auto& element : _monitor) {
+            if (element.second.IsRetired() == true) {
+                ipcCalls += element.second.IPCCalls();
+                continue;
+            }
+
+            SelfInfo::ObservableInfo& entry(response.Observables.Add());
+            entry.Callsign = element.first;
+            entry.Evaluate = element.second.EvaluateLatency();
+            entry.IPC = element.second.IPCCalls();
+            entry.Interval = element.second.MemoryInterval();
+            ipcCalls += element.second.IPCCalls();
+        }
+
+        _overheadLock.Lock();
+        response.Dispatch = _dispatchLatency;
+        response.Lateness = _lateness;
+        response.Requests = _requests;
+        response.Notifications = _notifications;
+        response.Activation = _activation;
+        response.Enforcement = _enforcement;
+        response.Startup = _startup;
+        _overheadLock.Unlock();
+
+        response.IPC = ipcCalls;
+    }
+
+    void Monitor::MonitorObjects::Recorded(RecorderInfo& response) const
+    {
+        std::vector<Recorder::Record> records;
+
+        response.Capacity = _recorder.Capacity();
+        response.Written = _recorder.Written();
+        response.Lost = _recorder.Read(records);
+
+        for (const Recorder::Record& record : records) {
+            RecorderInfo::RecordInfo& entry(response.Records.Add());
+
+            entry.Time = record.Time;
+            entry.Callsign = string(record.Callsign);
+            entry.Event = string(Recorder::Name(static_cast<Recorder::kind>(record.Kind)));
+            if (record.Kind == Recorder::DEACTIVATE) {
+                entry.Reason = MonitorObject::Notices::Name(static_cast<MonitorObject::Notices::reason>(record.Reason));
+            }
+            entry.Value = record.Value;
+            entry.Limit = record.Limit;
+            entry.Status = record.Status;
+        }
+    }
+
+    bool Monitor::MonitorObjects::Reset(const string& name, Monitor::MetaData& result, bool& operational)
+    {
+        bool found = false;
+
+        const Entry info(Find(name));
+
+        if ((info.IsValid() == true) && (info->IsRetired() == false)) {
+            result = info->Measurement();
+            operational = info->Operational();
+            info->Reset();
+            found = true;
+        }
+
+        return (found);
+    }
+
+    bool Monitor::MonitorObjects::Reset(const string& name)
+    {
+        bool found = false;
+
+        const Entry info(Find(name));
+
+        if ((info.IsValid() == true) && (info->IsRetired() == false)) {
+            info->Reset();
+            found = true;
+        }
+
+        return (found);
+    }
+
+    void Monitor::MonitorObjects::Dump()
+    {
+        RecorderInfo records;
+        string text;
+
+        _dumping = false;
+
+        Recorded(records);
+        records.ToString(text);
+
+        const string temporary(_dumpFile + _T(".tmp"));
+        std::ofstream stream(temporary, std::ios::out | std::ios::trunc);
+
+        stream << text;
+        stream.close();
+
+        if ((stream.fail() == true) || (::rename(temporary.c_str(), _dumpFile.c_str()) != 0)) {
+            TRACE(Trace::Error, (_T("Could not write the flight recorder to %s."), _dumpFile.c_str()));
+            ::unlink(temporary.c_str());
+        } else {
+            SYSLOG(Logging::Notification, (_T("Flight recorder written to %s."), _dumpFile.c_str()));
+        }
+    }
+
+    void Monitor::MonitorObjects::Archive()
+    {
+        _captureLock.Lock();
+
+        while (_captures.empty() == false) {
+            const Capture capture(std::move(_captures.front()));
+
+            _captureLock.Unlock();
+
+            const string text(capture.Text + _diagnostics.Capture(capture.Pid, _captureBudget));
+
+            if (_archive.Store(capture.Time, capture.Callsign, text) == true) {
+                SYSLOG(Logging::Notification, (_T("Diagnostics of %s written to %s."), capture.Callsign.c_str(), _archive.Directory().c_str()));
+            } else {
+                TRACE(Trace::Error, (_T("Could not write the diagnostics of %s to %s."), capture.Callsign.c_str(), _archive.Directory().c_str()));
+            }
+
+            _captureLock.Lock();
+            _captures.pop_front();
+        }
+
+        _captureLock.Unlock();
+    }
+
+    void Monitor::MonitorObjects::Dispatch()
+    {
+        uint64_t scheduledTime(Clock::Now());
+        uint64_t nextSlot(static_cast<uint64_t>(~0));
+
+        Purge();
+
+        // Go through the list of pending observations...
+        for (MonitorObjectContainer::value_type* index : Registry()) {
+            MonitorObject& info(index->second);
+
+            if ((info.Reconfigured(scheduledTime) == true) && (info.Group() != nullptr)) {
+                Limit(*info.Group(), info);
+            }
+
+            if (info.IsActive() == false) {
+                continue;
+            }
+
+            // A probe in flight is held against its deadline, whatever the slot of the observable.
+            const uint64_t started = info.ProbeStarted();
+            if ((started != 0) && (started != MonitorObject::ABANDONED)) {
+                const uint64_t deadline = started + info.ProbeTimeout();
+
+                if (deadline > scheduledTime) {
+                    if (deadline < nextSlot) {
+                        nextSlot = deadline;
+                    }
+                } else if (info.ProbeAbandon(started) == true) {
+                    _probes.Abandon();
+                    TRACE(Trace::Error, (_T("Probe of %s did not return within %d ms."), index->first.c_str(), static_cast<uint32_t>(info.ProbeTimeout() / 1000)));
+                    Enforce(index->first, info, MonitorObject::UNRESPONSIVE);
+                }
+            }
+
+            if (info.TimeSlot() <= scheduledTime) {
+                // From when it was due to when it is probed, the probes before it in this pass included.
+                const uint64_t lateness = Clock::Now() - info.TimeSlot();
+
+                _overheadLock.Lock();
+                _lateness.Set(lateness);
+                _overheadLock.Unlock();
+
+                uint32_t ticket = 0;
+
+                if (info.Probing(scheduledTime) == false) {
+                    // Hibernated or suspended, left alone for this slot.
+                } else if (info.ProbeTimeout() == 0) {
+                    const uint32_t value(info.Probe());
+                    Probed(index->first, info, value);
+                    Enforce(index->first, info, value);
+                } else if (info.ProbeStart(scheduledTime, ticket) == true) {
+                    // Probe on a thread of our own, a hanging observable should not hold up the others
+                    // nor the workers of the framework. Close waits for the probe threads.
+                    const string callsign(index->first);
+
+                    if (_probes.Submit([this, callsign, ticket]() { return (Probe(callsign, ticket)); }) == false) {
+                        info.ProbeEnd(ticket);
+                    }
+
+                    if ((scheduledTime + info.ProbeTimeout()) < nextSlot) {
+                        nextSlot = scheduledTime + info.ProbeTimeout();
+                    }
+                }
+                info.Retrigger(scheduledTime);
+            }
+
+            if (info.TimeSlot() < nextSlot) {
+                nextSlot = info.TimeSlot();
+            }
+        }
+
+        Balance();
+
+        if ((_summaryInterval != 0) && (_nextSummary <= scheduledTime)) {
+            Summarize();
+            _nextSummary = scheduledTime + _summaryInterval;
+        }
+
+        _overheadLock.Lock();
+        _dispatchLatency.Set(Clock::Now() - scheduledTime);
+        _overheadLock.Unlock();
+
+        if (nextSlot != static_cast<uint64_t>(~0)) {
+            if (nextSlot < Clock::Now()) {
+                _job.Submit();
+            } else {
+                nextSlot += 1000 /* Add 1 ms */;
+                _job.Reschedule(nextSlot);
+            }
+        } else {
+            TRACE(Trace::Information, (_T("Stopping to probe due to lack of active observees.")));
+        }
+    }
+
+    bool Monitor::MonitorObjects::Probe(const string& callsign, const uint32_t ticket)
+    {
+        const Entry info(Find(callsign));
+        bool abandoned = false;
+
+        if (info.IsValid() == true) {
+            const uint32_t value(info->Probe(ticket));
+
+            Probed(callsign, *info, value);
+
+            if (info->ProbeEnd(ticket) == false) {
+                abandoned = true;
+            } else if (info->IsRetired() == false) {
+                Enforce(callsign, *info, value);
+                Balance();
+            }
+        }
+
+        return (abandoned);
+    }
+
+    void Monitor::MonitorObjects::Probed(const string& callsign, MonitorObject& info, const uint32_t value)
+    {
+        const uint64_t arrival = info.Arrival();
+
+        _recorder.Write(Recorder::SAMPLE, callsign, info.Resident() / 1024, info.MemoryThreshold() / 1024, value);
+
+        _aggregate += info.Settle();
+
+        if (arrival != 0) {
+            _overheadLock.Lock();
+            _activation.Set(arrival);
+            _overheadLock.Unlock();
+        }
+    }
+
+    void Monitor::MonitorObjects::Balance()
+    {
+        if ((_budget != 0) && (_aggregate > _budget)) {
+            Core::SafeSyncType<Core::CriticalSection> guard(_budgetLock);
+            std::list<std::pair<string, Entry>> victims;
+
+            _registryLock.Lock();
+
+            uint64_t projected = _aggregate;
+
+            // Whatever is on its way out already no longer counts.
+            for (const auto& element : _monitor) {
+                if ((element.second.IsVictim() == true) || (element.second.IsClaimed() == true)) {
+                    projected -= std::min(projected, element.second.Resident());
+                }
+            }
+
+            while (projected > _budget) {
+                MonitorObjectContainer::iterator victim(_monitor.end());
+
+                for (MonitorObjectContainer::iterator index(_monitor.begin()); index != _monitor.end(); ++index) {
+                    const MonitorObject& candidate(index->second);
+
+                    if ((candidate.IsActive() == true) && (candidate.IsRetired() == false) && (candidate.IsVictim() == false) && (candidate.IsClaimed() == false) && (candidate.Resident() != 0) && ((victim == _monitor.end()) || (Preferred(candidate, victim->second) == true))) {
+                        victim = index;
+                    }
+                }
+
+                if (victim == _monitor.end()) {
+                    break;
+                }
+
+                TRACE(Trace::Error, (_T("Budget of %s KiB exceeded by %s KiB, %s has to go."), std::to_string(_budget / 1024).c_str(), std::to_string((projected - _budget) / 1024).c_str(), victim->first.c_str()));
+
+                victim->second.Victim();
+                projected -= std::min(projected, victim->second.Resident());
+                victims.emplace_back(victim->first, Entry(&(victim->second)));
+            }
+
+            _registryLock.Unlock();
+
+            // A victim that got taken down by someone else in the mean time is left to them.
+            for (const std::pair<string, Entry>& victim : victims) {
+                Enforce(victim.first, *victim.second, MonitorObject::EXCEEDED_BUDGET);
+            }
+        }
+    }
+
+    void Monitor::MonitorObjects::Connected(RPC::IRemoteConnection* connection, const bool up)
+    {
+        RPC::IMonitorableProcess* process = connection->QueryInterface<RPC::IMonitorableProcess>();
+
+        if (process != nullptr) {
+            const string callsign(process->Callsign());
+            process->Release();
+
+            const Entry info(Find(callsign));
+
+            if (info.IsValid() == true) {
+                info->Host(up == true ? connection->RemoteId() : 0);
+            }
+
+            if (_cgroupRoot.empty() == false) {
+                if (up == true) {
+                    Confine(callsign, connection->RemoteId());
+                } else {
+                    Release(callsign);
+                }
+            }
+        }
+    }
+
+    void Monitor::MonitorObjects::Confine(const string& callsign, const uint32_t pid)
+    {
+        const Entry entry(Find(callsign));
+
+        if ((entry.IsValid() == true) && (entry->IsRetired() == false)) {
+            MonitorObject& info(*entry);
+            const std::shared_ptr<CGroup> group(std::make_shared<CGroup>(_cgroupRoot, callsign));
+
+            if ((group->Create() == true) && (group->Attach(pid) == true)) {
+                Limit(*group, info);
+                group->Changed();
+
+                const int watch(_containment.Add(group->EventsFile()));
+                if (watch >= 0) {
+                    _cgroupLock.Lock();
+                    _watches[watch] = callsign;
+                    _cgroupLock.Unlock();
+                }
+
+                info.Confine(group, watch);
+
+                TRACE(Trace::Information, (_T("Confined %s (%u) to %s."), callsign.c_str(), pid, group->Path().c_str()));
+            } else {
+                TRACE(Trace::Error, (_T("Could not confine %s (%u) to %s."), callsign.c_str(), pid, group->Path().c_str()));
+            }
+        }
+    }
+
+    void Monitor::MonitorObjects::Release(const string& callsign)
+    {
+        const Entry info(Find(callsign));
+
+        if (info.IsValid() == true) {
+            const std::shared_ptr<CGroup> group(info->Group());
+
+            if (group != nullptr) {
+                const int watch(info->Watch());
+
+                info->Confine(nullptr, -1);
+
+                if (watch >= 0) {
+                    _containment.Remove(watch);
+                    _cgroupLock.Lock();
+                    _watches.erase(watch);
+                    _cgroupLock.Unlock();
+                }
+
+                // Still busy if the process did not exit yet, it is reused on the next activation.
+                group->Remove();
+            }
+        }
+    }
+
+    void Monitor::MonitorObjects::Contained(const int watch)
+    {
+        string callsign;
+
+        _cgroupLock.Lock();
+        std::map<int, string>::const_iterator entry(_watches.find(watch));
+        if (entry != _watches.end()) {
+            callsign = entry->second;
+        }
+        _cgroupLock.Unlock();
+
+        const Entry info(Find(callsign));
+
+        if (info.IsValid() == true) {
+            const std::shared_ptr<CGroup> group(info->Group());
+
+            if (group != nullptr) {
+                const CGroup::Events events(group->Changed());
+
+                if ((events.Oom != 0) || (events.OomKill != 0)) {
+                    TRACE(Trace::Error, (_T("OOM in the group of %s."), callsign.c_str()));
+                    Enforce(callsign, *info, MonitorObject::EXCEEDED_MEMORY);
+                } else if (((events.High != 0) || (events.Max != 0)) && (info->Nudge(Clock::Now()) == true)) {
+                    Enforce(callsign, *info, MonitorObject::MEMORY_PRESSURE);
+                }
+            }
+        }
+    }
+
+    void Monitor::MonitorObjects::Enforce(const string& callsign, MonitorObject& info, const uint32_t value)
+    {
+        const bool deactivate = ((value & (MonitorObject::NOT_OPERATIONAL | MonitorObject::EXCEEDED_MEMORY | MonitorObject::UNRESPONSIVE | MonitorObject::EXCEEDED_BUDGET)) != 0);
+
+        // The job, a probe thread and the cgroup events may all see the same violation, only
+        // the one that claims the observable acts on it. Nothing is reported for an observable
+        // that is on its way out already.
+        if ((deactivate == true) ? (info.Claim() == true) : (info.IsClaimed() == false)) {
+            const MonitorObject::Notices& notices(info.Notice());
+            const std::vector<ProcessRoles::Culprit> culprits((value & (MonitorObject::EXCEEDED_MEMORY | MonitorObject::EXCEEDED_PROCESS)) != 0 ? info.Culprits() : std::vector<ProcessRoles::Culprit>());
+
+            if ((value & MonitorObject::MEMORY_PRESSURE) != 0) {
+                const uint64_t resident(info.Lifetime(Metrics::RESIDENT).Last() / 1024);
+                const uint64_t limit(info.PressureThreshold() / 1024);
+
+                SYSLOG(Logging::Notification, (_T("Memory pressure: %s resident %s KiB, soft limit %s KiB."), callsign.c_str(), std::to_string(resident).c_str(), std::to_string(limit).c_str()));
+
+                _recorder.Write(Recorder::PRESSURE, callsign, resident, limit, value);
+
+                _telemetry.Event(_markers.Pressure, callsign);
+
+                _service->Notify(notices.Pressure(resident, limit));
+
+                _parent.event_memorypressure(callsign, resident, limit);
+            }
+            if (deactivate == true) {
+                const uint64_t start = Clock::Now();
+
+                // The shell captured on activation, only a detached observable needs the lookup.
+                PluginHost::IShell* plugin(info.Shell());
+
+                if (plugin == nullptr) {
+                    _ipcCalls++;
+                    plugin = _service->QueryInterfaceByCallsign<PluginHost::IShell>(callsign);
+                }
+
+                if (plugin != nullptr) {
+                    MonitorObject::Notices::reason which;
+
+                    if ((value & (MonitorObject::EXCEEDED_MEMORY | MonitorObject::NOT_OPERATIONAL)) != 0) {
+                        which = (((value & (MonitorObject::EXCEEDED_MEMORY | MonitorObject::EXCEEDED_BUDGET)) != 0) ? MonitorObject::Notices::MEMORY : MonitorObject::Notices::FAILURE);
+                    } else {
+                        which = (((value & MonitorObject::EXCEEDED_BUDGET) != 0) ? MonitorObject::Notices::BUDGET : MonitorObject::Notices::UNRESPONSIVE);
+                    }
+
+                    const PluginHost::IShell::reason why(((which == MonitorObject::Notices::MEMORY) || (which == MonitorObject::Notices::BUDGET)) ? PluginHost::IShell::MEMORY_EXCEEDED : PluginHost::IShell::FAILURE);
+
+                    SYSLOG(Logging::Fatal, (_T("FORCED Shutdown: %s by reason: %s."), callsign.c_str(), notices.Reason(which).c_str()));
+
+                    for (const ProcessRoles::Culprit& culprit : culprits) {
+                        if (culprit.Narrow == false) {
+                            SYSLOG(Logging::Fatal, (_T("Blamed: %s process %s (%u) resident %s KiB, limit %s KiB."), callsign.c_str(), culprit.Role.c_str(), culprit.Pid, std::to_string(culprit.Resident).c_str(), std::to_string(culprit.Limit).c_str()));
+                        }
+                    }
+                    if ((value & MonitorObject::EXCEEDED_GRAPHICS) != 0) {
+                        SYSLOG(Logging::Fatal, (_T("Blamed: %s dma-buf %s KiB, limit %s KiB."), callsign.c_str(), std::to_string(info.Lifetime(Metrics::DMABUF).Last() / 1024).c_str(), std::to_string(info.GraphicsThreshold() / 1024).c_str()));
+                    }
+
+                    _recorder.Write(Recorder::DEACTIVATE, callsign, info.Resident() / 1024, info.MemoryThreshold() / 1024, value, which);
+
+                    _telemetry.Event(_markers.Deactivate, notices.Marker(which));
+                    if (why == PluginHost::IShell::FAILURE) {
+                        _telemetry.Immediate(info.FailureMarker());
+                    }
+
+                    _service->Notify(notices.Deactivate(which));
+
+                    _parent.event_action(callsign, "Deactivate", notices.Reason(which));
+
+                    Core::IWorkerPool::Instance().Submit(PluginHost::IShell::Job::Create(plugin, PluginHost::IShell::DEACTIVATED, why));
+
+                    // Read while the plugin shuts down, its process is only gone once the shutdown is over.
+                    if (_archiver.IsValid() == true) {
+                        Diagnose(callsign, info, notices.Reason(which));
+                    }
+
+                    plugin->Release();
+
+                    _overheadLock.Lock();
+                    _enforcement.Set(Clock::Now() - start);
+                    _overheadLock.Unlock();
+                } else {
+                    info.Unclaim();
+                }
+            } else if ((value & MonitorObject::EXCEEDED_PROCESS) != 0) {
+                Kill(callsign, culprits);
+            }
+        }
+    }
+
+    void Monitor::MonitorObjects::Kill(const string& callsign, const std::vector<ProcessRoles::Culprit>& culprits)
+    {
+        const uint64_t start = Clock::Now();
+        const ProcessTree tree;
+
+        for (const ProcessRoles::Culprit& culprit : culprits) {
+            if ((culprit.Narrow == true) && (tree.Kill(culprit.Pid, culprit.Role) == true)) {
+                SYSLOG(Logging::Fatal, (_T("FORCED Kill: %s process %s (%u) resident %s KiB, limit %s KiB."), callsign.c_str(), culprit.Role.c_str(), culprit.Pid, std::to_string(culprit.Resident).c_str(), std::to_string(culprit.Limit).c_str()));
+
+                _recorder.Write(Recorder::KILL, callsign, culprit.Resident, culprit.Limit, culprit.Pid);
+
+                _service->Notify(_T("{\"callsign\": \"") + callsign + _T("\", \"action\": \"Kill\", \"reason\": \"") + culprit.Role + _T("\" }"));
+
+                _parent.event_action(callsign, "Kill", culprit.Role);
+            }
+        }
+
+        _overheadLock.Lock();
+        _enforcement.Set(Clock::Now() - start);
+        _overheadLock.Unlock();
+    }
+
+    void Monitor::MonitorObjects::Diagnose(const string& callsign, const MonitorObject& info, const string& reason)
+    {
+        const uint32_t pid(info.Host());
+
+        if (pid != 0) {
+            const uint64_t now = Clock::Now();
+            Capture capture { now, callsign, pid, "=== " + callsign + ' ' + std::to_string(pid) + ' ' + reason + '\n' };
+
+            _captureLock.Lock();
+
+            const bool idle = _captures.empty();
+
+            if (_captures.size() < PendingCaptures) {
+                _captures.push_back(std::move(capture));
+            } else {
+                TRACE(Trace::Error, (_T("Diagnostics of %s dropped, %d captures are waiting to be written."), callsign.c_str(), PendingCaptures));
+            }
+
+            _captureLock.Unlock();
+
+            if (idle == true) {
+                Core::IWorkerPool::Instance().Submit(_archiver);
+            }
+        }
+    }
+
+    void Monitor::MonitorObjects::Summarize()
+    {
+        string summary;
+
+        _registryLock.Lock();
+        for (const auto& element : _monitor) {
+            if ((element.second.IsActive() == true) && (element.second.IsRetired() == false)) {
+                const Core::MeasurementType<uint64_t> resident(element.second.Lifetime(Metrics::RESIDENT));
+
+                if (resident.Measurements() != 0) {
+                    if (summary.empty() == false) {
+                        summary += ',';
+                    }
+                    summary += element.first + ':' + std::to_string(resident.Last() / 1024) + ':' + std::to_string(resident.Max() / 1024);
+                }
+            }
+        }
+        _registryLock.Unlock();
+
+        if (summary.empty() == false) {
+            _telemetry.Value(_markers.Memory, summary);
+        }
+    }
+
+    void Monitor::MonitorObjects::Purge()
+    {
+        Core::SafeSyncType<Core::CriticalSection> guard(_registryLock);
+        MonitorObjectContainer::iterator index(_monitor.begin());
+
+        while (index != _monitor.end()) {
+            if (index->second.IsDisposable() == true) {
+                index = _monitor.erase(index);
+            } else {
+                ++index;
+            }
+        }
+    }
+
+    std::vector<Monitor::MonitorObjects::MonitorObjectContainer::value_type*> Monitor::MonitorObjects::Registry()
+    {
+        std::vector<MonitorObjectContainer::value_type*> result;
+
+        _registryLock.Lock();
+        result.reserve(_monitor.size());
+        for (auto& element : _monitor) {
+            if (element.second.IsRetired() == false) {
+                result.push_back(&element);
+            }
+        }
+        _registryLock.Unlock();
+
+        return (result);
+    }
+
+    void Monitor::MonitorObjects::Retire(const string& callsign)
+    {
+        const Entry info(Find(callsign));
+
+        if (info.IsValid() == true) {
+            Release(callsign);
+            info->Detach();
+            info->Set(nullptr);
+            info->Active(false);
+            _aggregate += info->Settle();
+            info->Disposable();
+        }
+    }
+
+} // namespace Plugin
+} // namespace WPEFramework
@@ -0,0 +1,237 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __MONITOR_PROBER_H
+#define __MONITOR_PROBER_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <thread>
+
+namespace WPEFramework {
+namespace Plugin {
+
+    // A few threads of its own to run probes on, so an observable that hangs in
+    // a call ties up one of these instead of the workers the framework shares.
+    // A thread whose task was given up on is replaced, as long as the spare
+    // threads last, and leaves once the call returns. Every thread is joined:
+    // Close drops what is queued and waits for what runs, so nothing started
+    // here outlives the pool, nor the one that owns it.
+    class Prober {
+    public:
+        using Task = std::function<bool()>; //!< True if the task was given up on while it ran.
+
+    public:
+        Prober(const Prober&) = delete;
+        Prober& operator=(const Prober&) = delete;
+
+        Prober()
+            : _lock()
+            , _signal()
+            , _queue()
+            , _workers()
+            , _threads(0)
+            , _base(0)
+            , _limit(0)
+            , _running(0)
+            , _hung(0)
+            , _open(false)
+        {
+        }
+        ~Prober()
+        {
+            Close();
+        }
+
+    public:
+        // The threads to start with, and how many may be added in place of threads tied up by a task given up on.
+        bool Open(const uint8_t threads, const uint8_t spare)
+        {
+            std::unique_lock<std::mutex> guard(_lock);
+
+            bool result = (_open == false);
+
+            if (result == true) {
+                _open = true;
+                _base = (threads == 0 ? 1 : threads);
+                _limit = _base + spare;
+                _hung = 0;
+
+                for (uint8_t index = 0; index < _base; index++) {
+                    Spawn();
+                }
+            }
+
+            return (result);
+        }
+        // Drops the queued tasks and waits till every thread left, those running a
+        // task once it returned. Returns the tasks that were running when called.
+        uint32_t Close()
+        {
+            std::list<Task> dropped;
+            std::list<Worker> workers;
+            uint32_t result;
+
+            _lock.lock();
+            _open = false;
+            dropped.swap(_queue);
+            workers.swap(_workers);
+            result = _running;
+            _signal.notify_all();
+            _lock.unlock();
+
+            // Destructed before the wait, not under the lock, a task may own more than it runs.
+            dropped.clear();
+
+            for (Worker& worker : workers) {
+                worker.Thread.join();
+            }
+
+            return (result);
+        }
+        // False if the pool is not open, the task is dropped.
+        bool Submit(Task&& task)
+        {
+            std::unique_lock<std::mutex> guard(_lock);
+            bool result = false;
+
+            if (_open == true) {
+                Reap();
+                _queue.push_back(std::move(task));
+                _signal.notify_one();
+                result = true;
+            }
+
+            return (result);
+        }
+        // A task is given up on, another thread takes over from the one it ties
+        // up, unless all spare threads are tied up already.
+        void Abandon()
+        {
+            std::unique_lock<std::mutex> guard(_lock);
+
+            if (_open == true) {
+                Reap();
+
+                _hung++;
+
+                if ((Healthy() < _base) && (_threads < _limit)) {
+                    Spawn();
+                }
+            }
+        }
+        // Tasks that are being run right now, the ones that hang included.
+        uint32_t Running() const
+        {
+            std::unique_lock<std::mutex> guard(_lock);
+            return (_running);
+        }
+        // Threads that have not left yet, the ones that hang included.
+        uint32_t Threads() const
+        {
+            std::unique_lock<std::mutex> guard(_lock);
+            return (_threads);
+        }
+
+    private:
+        struct Worker {
+            std::thread Thread;
+            bool Done; //!< Left, only has to be joined.
+        };
+
+        // Called with the lock taken. Threads that are not tied up by a task given up on.
+        inline int64_t Healthy() const
+        {
+            return (static_cast<int64_t>(_threads) - _hung);
+        }
+        // Called with the lock taken.
+        void Spawn()
+        {
+            _workers.emplace_back();
+            _workers.back().Done = false;
+            _threads++;
+            _workers.back().Thread = std::thread(&Prober::Run, this, &_workers.back());
+        }
+        // Called with the lock taken. A thread marks itself done under the lock,
+        // as the last thing it does, so it is not held up by the join.
+        void Reap()
+        {
+            std::list<Worker>::iterator index(_workers.begin());
+
+            while (index != _workers.end()) {
+                if (index->Done == true) {
+                    index->Thread.join();
+                    index = _workers.erase(index);
+                } else {
+                    ++index;
+                }
+            }
+        }
+        void Run(Worker* self)
+        {
+            std::unique_lock<std::mutex> guard(_lock);
+            bool leave = false;
+
+            while ((_open == true) && (leave == false)) {
+                if (_queue.empty() == true) {
+                    _signal.wait(guard);
+                } else {
+                    Task task(std::move(_queue.front()));
+                    _queue.pop_front();
+                    _running++;
+
+                    guard.unlock();
+                    const bool abandoned = task();
+                    task = nullptr;
+                    guard.lock();
+
+                    _running--;
+
+                    // Replaced when its task was given up on, so it makes way now if it was.
+                    if (abandoned == true) {
+                        _hung--;
+                        leave = (Healthy() > _base);
+                    }
+                }
+            }
+
+            _threads--;
+            self->Done = true;
+        }
+
+    private:
+        mutable std::mutex _lock;
+        std::condition_variable _signal;
+        std::list<Task> _queue;
+        std::list<Worker> _workers; //!< Nodes do not move, a thread keeps a pointer to its own.
+        uint32_t _threads;
+        uint32_t _base; //!< Threads to keep free of tasks that were given up on.
+        uint32_t _limit; //!< Threads there may be at most, the spare ones included.
+        uint32_t _running;
+        int32_t _hung; //!< Tasks given up on that did not return yet, briefly -1 if one returns before it is given up on.
+        bool _open;
+    };
+
+} // namespace Plugin
+} // namespace WPEFramework
+
+#endif // __MONITOR_PROBER_H
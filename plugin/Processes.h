@@ -0,0 +1,263 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __MONITOR_PROCESSES_H
+#define __MONITOR_PROCESSES_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <signal.h>
+#include <sys/types.h>
+
+#include "Rules.h"
+
+namespace WPEFramework {
+namespace Plugin {
+
+    // The processes of an observable, the host process and all its descendants, as
+    // /proc shows them. Plain file access only, so it works just as well on a fake
+    // tree in a tmpfs.
+    class ProcessTree {
+    public:
+        // Sizes in bytes.
+        struct Process {
+            uint32_t Pid;
+            std::string Name;
+            uint64_t Resident;
+            uint64_t Proportional; //!< PSS, 0 if the kernel has no smaps_rollup.
+        };
+
+    public:
+        explicit ProcessTree(const std::string& proc = "/proc")
+            : _proc(proc)
+        {
+        }
+        ProcessTree(const ProcessTree&) = default;
+        ProcessTree& operator=(const ProcessTree&) = default;
+        ~ProcessTree() = default;
+
+    public:
+        // Host first, then its children, a level at a time, as task/<tid>/children lists them.
+        // A process that went away in between is left out.
+        std::vector<Process> Walk(const uint32_t pid) const
+        {
+            std::vector<Process> result;
+            std::vector<uint32_t> pending(1, pid);
+
+            for (uint32_t index = 0; index < pending.size(); index++) {
+                const std::string path(_proc + '/' + std::to_string(pending[index]));
+                std::string text;
+
+                if (Read(path + "/status", text) == true) {
+                    Process process;
+
+                    process.Pid = pending[index];
+                    process.Name = Field(text, "Name:");
+                    process.Resident = std::strtoull(Field(text, "VmRSS:").c_str(), nullptr, 10) * 1024;
+                    process.Proportional = ((Read(path + "/smaps_rollup", text) == true) ? std::strtoull(Field(text, "Pss:").c_str(), nullptr, 10) * 1024 : 0);
+
+                    result.push_back(std::move(process));
+
+                    Children(path, pending);
+                }
+            }
+
+            return (result);
+        }
+        // The same order as Walk, but only the children lists are read.
+        std::vector<uint32_t> Pids(const uint32_t pid) const
+        {
+            std::vector<uint32_t> result(1, pid);
+
+            for (uint32_t index = 0; index < result.size(); index++) {
+                Children(_proc + '/' + std::to_string(result[index]), result);
+            }
+
+            return (result);
+        }
+        // Empty if there is no such process.
+        std::string Name(const uint32_t pid) const
+        {
+            std::string text;
+
+            return (Read(_proc + '/' + std::to_string(pid) + "/status", text) == true ? Field(text, "Name:") : std::string());
+        }
+        // Only if it still goes by that name, the pid may have been reused since it was read.
+        bool Kill(const uint32_t pid, const std::string& name) const
+        {
+            return ((Name(pid) == name) && (::kill(static_cast<pid_t>(pid), SIGKILL) == 0));
+        }
+
+    private:
+        void Children(const std::string& path, std::vector<uint32_t>& pending) const
+        {
+            DIR* list = ::opendir((path + "/task").c_str());
+
+            if (list != nullptr) {
+                struct dirent* entry;
+
+                while ((entry = ::readdir(list)) != nullptr) {
+                    std::string children;
+
+                    if ((entry->d_name[0] != '.') && (Read(path + "/task/" + entry->d_name + "/children", children) == true)) {
+                        std::istringstream pids(children);
+                        uint32_t child;
+
+                        while (pids >> child) {
+                            pending.push_back(child);
+                        }
+                    }
+                }
+
+                ::closedir(list);
+            }
+        }
+        // What follows the key on its line, without the leading white space.
+        static std::string Field(const std::string& text, const char key[])
+        {
+            std::istringstream lines(text);
+            std::string line;
+
+            while (std::getline(lines, line)) {
+                if (line.compare(0, ::strlen(key), key) == 0) {
+                    const size_t start = line.find_first_not_of(" \t", ::strlen(key));
+                    return (start != std::string::npos ? line.substr(start) : std::string());
+                }
+            }
+
+            return (std::string());
+        }
+        static bool Read(const std::string& file, std::string& text)
+        {
+            std::ifstream stream(file);
+            bool result = stream.is_open();
+
+            if (result == true) {
+                std::stringstream buffer;
+                buffer << stream.rdbuf();
+                text = buffer.str();
+            }
+
+            return (result);
+        }
+
+    private:
+        std::string _proc;
+    };
+
+    // Limits on the processes of an observable by role, the process name, e.g.
+    // WPEWebProcess. Each role runs its samples through the same filter the
+    // observable uses, a role is over its limit if any process in it is.
+    class ProcessRoles {
+    public:
+        struct Role {
+            std::string Name;
+            uint64_t Limit; //!< KiB resident.
+            bool Narrow; //!< Only the process is killed, not the whole observable shut down.
+
+            bool operator==(const Role& rhs) const
+            {
+                return ((Name == rhs.Name) && (Limit == rhs.Limit) && (Narrow == rhs.Narrow));
+            }
+        };
+
+        // A process to blame, sizes in KiB.
+        struct Culprit {
+            uint32_t Pid;
+            std::string Role;
+            uint64_t Resident;
+            uint64_t Limit;
+            bool Narrow;
+        };
+
+    public:
+        ProcessRoles()
+            : _roles()
+        {
+        }
+        ProcessRoles(const ProcessRoles&) = delete;
+        ProcessRoles& operator=(const ProcessRoles&) = delete;
+        ~ProcessRoles() = default;
+
+    public:
+        inline bool IsEmpty() const
+        {
+            return (_roles.empty());
+        }
+        // The filters start afresh.
+        void Configure(const std::vector<Role>& roles, const Violation& rule)
+        {
+            _roles.clear();
+
+            for (const Role& role : roles) {
+                _roles.push_back({ role, rule });
+                _roles.back().Filter.Reset();
+            }
+        }
+        void Reset()
+        {
+            for (Entry& entry : _roles) {
+                entry.Filter.Reset();
+            }
+        }
+        // The processes of the roles the filter fired on, only those that are over the limit.
+        std::vector<Culprit> Check(const std::vector<ProcessTree::Process>& processes, const uint64_t now /* MicroSeconds */)
+        {
+            std::vector<Culprit> result;
+
+            for (Entry& entry : _roles) {
+                const uint64_t limit = entry.Setting.Limit * 1024;
+                bool over = false;
+
+                for (const ProcessTree::Process& process : processes) {
+                    over = over || ((limit != 0) && (process.Name == entry.Setting.Name) && (process.Resident > limit));
+                }
+
+                if (entry.Filter.Set(over, now) == true) {
+                    for (const ProcessTree::Process& process : processes) {
+                        if ((process.Name == entry.Setting.Name) && (process.Resident > limit)) {
+                            result.push_back({ process.Pid, process.Name, process.Resident / 1024, entry.Setting.Limit, entry.Setting.Narrow });
+                        }
+                    }
+                }
+            }
+
+            return (result);
+        }
+
+    private:
+        struct Entry {
+            Role Setting;
+            Violation Filter;
+        };
+
+        std::vector<Entry> _roles;
+    };
+
+} // namespace Plugin
+} // namespace WPEFramework
+
+#endif // __MONITOR_PROCESSES_H
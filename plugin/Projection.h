@@ -0,0 +1,214 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __MONITOR_PROJECTION_H
+#define __MONITOR_PROJECTION_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "Metrics.h"
+
+namespace WPEFramework {
+namespace Plugin {
+
+    // What a status request asks for: which observables, which of their fields and
+    // since when. Fields are named as in the status, a metric on its own
+    // ("resident") or one statistic of it ("resident.last"). Since is a generation
+    // a previous status handed out, e.g.
+    //
+    //     Cobalt,Netflix?fields=resident.last,operational&since=1718000000000042
+    //
+    // Everything is selected unless a list says otherwise. What is not selected is
+    // never filled in, so it takes neither time nor room in the response.
+    class Projection {
+    public:
+        enum statistic : uint8_t {
+            MIN = 0x01,
+            MAX = 0x02,
+            AVERAGE = 0x04,
+            LAST = 0x08,
+            P50 = 0x10,
+            P95 = 0x20,
+            P99 = 0x40,
+            RECENT = 0x80,
+            STATISTICS = 0xFF
+        };
+        enum field : uint8_t {
+            OPERATIONAL = 0x01,
+            COUNT = 0x02,
+            PROCESSES = 0x04,
+            RESTART = 0x08,
+            FIELDS = 0x0F
+        };
+
+    public:
+        Projection()
+            : _statistics()
+            , _fields(FIELDS)
+            , _since(0)
+        {
+            for (uint8_t& statistics : _statistics) {
+                statistics = STATISTICS;
+            }
+        }
+        Projection(const Projection&) = default;
+        Projection& operator=(const Projection&) = default;
+        ~Projection() = default;
+
+    public:
+        inline uint8_t Statistics(const Metrics::metric which) const
+        {
+            return (_statistics[which]);
+        }
+        inline bool Has(const field which) const
+        {
+            return ((_fields & which) != 0);
+        }
+        // Only what changed after this generation, 0 for everything.
+        inline uint64_t Since() const
+        {
+            return (_since);
+        }
+        // Comma separated field names, empty selects everything. False on a name that
+        // is not known, the projection is left as it was then.
+        bool Fields(const std::string& list)
+        {
+            bool result = true;
+
+            if (list.empty() == false) {
+                Projection selection;
+
+                for (uint8_t& statistics : selection._statistics) {
+                    statistics = 0;
+                }
+                selection._fields = 0;
+
+                for (const std::string& name : Split(list, ',')) {
+                    result = result && (selection.Select(name) == true);
+                }
+
+                if (result == true) {
+                    *this = selection;
+                }
+            }
+
+            return (result);
+        }
+        // The fields and since parameters of a query string, false on a field that is not known.
+        bool Query(const std::string& query)
+        {
+            const bool result = Fields(Parameter(query, "fields"));
+
+            if (result == true) {
+                _since = std::strtoull(Parameter(query, "since").c_str(), nullptr, 10);
+            }
+
+            return (result);
+        }
+        // "<callsign>[,<callsign>...][?<query>]", no callsigns selects them all.
+        static bool Parse(const std::string& request, std::vector<std::string>& callsigns, Projection& projection)
+        {
+            const size_t query = request.find('?');
+
+            callsigns = Split(request.substr(0, query), ',');
+
+            return ((query == std::string::npos) || (projection.Query(request.substr(query + 1)) == true));
+        }
+        // The value of key in a query string, "a=1&b=2".
+        static std::string Parameter(const std::string& query, const char key[])
+        {
+            std::string result;
+
+            for (const std::string& parameter : Split(query, '&')) {
+                const size_t length = ::strlen(key);
+
+                if ((parameter.length() > length) && (parameter[length] == '=') && (parameter.compare(0, length, key) == 0)) {
+                    result = parameter.substr(length + 1);
+                }
+            }
+
+            return (result);
+        }
+        // Without the empty parts.
+        static std::vector<std::string> Split(const std::string& text, const char separator)
+        {
+            std::vector<std::string> result;
+            size_t start = 0;
+
+            while (start <= text.length()) {
+                const size_t end = std::min(text.find(separator, start), text.length());
+
+                if (end > start) {
+                    result.push_back(text.substr(start, end - start));
+                }
+
+                start = end + 1;
+            }
+
+            return (result);
+        }
+
+    private:
+        bool Select(const std::string& name)
+        {
+            static const char* const Statistics[] = { "min", "max", "average", "last", "p50", "p95", "p99", "recent" };
+            static const char* const Fields[] = { "operational", "count", "processes", "restart" };
+
+            const size_t dot = name.find('.');
+            const Metrics::metric metric = Metrics::Find(name.substr(0, dot));
+            bool result = false;
+
+            if (metric != Metrics::METRICS) {
+                if (dot == std::string::npos) {
+                    _statistics[metric] = STATISTICS;
+                    result = true;
+                } else {
+                    for (uint8_t statistic = 0; (result == false) && (statistic < 8); statistic++) {
+                        if (name.compare(dot + 1, std::string::npos, Statistics[statistic]) == 0) {
+                            _statistics[metric] |= static_cast<uint8_t>(1 << statistic);
+                            result = true;
+                        }
+                    }
+                }
+            }
+            for (uint8_t index = 0; (result == false) && (dot == std::string::npos) && (index < 4); index++) {
+                if (name == Fields[index]) {
+                    _fields |= static_cast<uint8_t>(1 << index);
+                    result = true;
+                }
+            }
+
+            return (result);
+        }
+
+    private:
+        uint8_t _statistics[Metrics::METRICS];
+        uint8_t _fields;
+        uint64_t _since;
+    };
+
+} // namespace Plugin
+} // namespace WPEFramework
+
+#endif // __MONITOR_PROJECTION_H
@@ -0,0 +1,217 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __MONITOR_RECORDER_H
+#define __MONITOR_RECORDER_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Clock.h"
+
+namespace WPEFramework {
+namespace Plugin {
+
+    // Keeps the latest records of what the Monitor saw and did, for a look back
+    // after the fact. Writers, from any thread, claim a slot with one atomic add
+    // and fill it in without locks or allocations; the oldest records are
+    // overwritten. Every slot carries a sequence number that is odd while it is
+    // written, so a reader skips what is being written or was overwritten while
+    // it copied, instead of holding the writers up.
+    class Recorder {
+    public:
+        enum kind : uint8_t {
+            SAMPLE = 0, //!< A probe, Value is the resident KiB, Limit the memory limit, Status what it found.
+            PRESSURE = 1, //!< Over the soft limit, Value is the resident KiB, Limit the soft limit.
+            DEACTIVATE = 2, //!< Shut down, Reason as in MonitorObject::Notices, Status what triggered it.
+            RESTART = 3, //!< Restarted after it went down.
+            GIVEUP = 4, //!< Went down too often, Value is the restart limit, Limit the window in seconds.
+            KILL = 5 //!< A process over the limit of its role was killed, Value is its resident KiB, Status its pid.
+        };
+
+        struct Record {
+            uint64_t Time; //!< MicroSeconds since the epoch.
+            uint64_t Value;
+            uint64_t Limit;
+            uint32_t Status;
+            uint8_t Kind;
+            uint8_t Reason;
+            char Callsign[26]; //!< Cut short if it does not fit, always terminated.
+        };
+
+        static constexpr uint32_t DefaultCapacity = 1024;
+
+    private:
+        static constexpr uint8_t Words = sizeof(Record) / sizeof(uint64_t);
+
+        static_assert((sizeof(Record) % sizeof(uint64_t)) == 0, "A record is copied word by word.");
+
+        // A record and its sequence number fill a cache line.
+        struct Slot {
+            std::atomic<uint64_t> Sequence;
+            std::atomic<uint64_t> Data[Words];
+        };
+
+    public:
+        Recorder(const Recorder&) = delete;
+        Recorder& operator=(const Recorder&) = delete;
+
+        Recorder()
+            : _slots()
+            , _capacity(0)
+            , _head(0)
+        {
+        }
+        ~Recorder() = default;
+
+    public:
+        static const char* Name(const kind which)
+        {
+            static const char* const names[] = { "Sample", "Pressure", "Deactivate", "Restart", "GiveUp", "Kill" };
+
+            return (which <= KILL ? names[which] : "Unknown");
+        }
+
+        inline uint32_t Capacity() const
+        {
+            return (_capacity);
+        }
+        // Records written so far, the ones overwritten included.
+        inline uint64_t Written() const
+        {
+            return (_head.load(std::memory_order_relaxed));
+        }
+        // Before anything is written, the capacity is rounded up to a power of two. Whatever was recorded is gone.
+        void Open(const uint32_t capacity)
+        {
+            uint32_t size = 1;
+
+            while ((size < capacity) && (size < (1u << 20))) {
+                size <<= 1;
+            }
+
+            _slots.reset(new Slot[size]);
+            _capacity = size;
+            _head = 0;
+
+            for (uint32_t index = 0; index < size; index++) {
+                _slots[index].Sequence.store(0, std::memory_order_relaxed);
+            }
+        }
+        void Write(const kind which, const std::string& callsign, const uint64_t value, const uint64_t limit, const uint32_t status, const uint8_t reason = 0)
+        {
+            if (_capacity != 0) {
+                uint64_t data[Words];
+                Record record;
+
+                record.Time = Clock::Now();
+                record.Value = value;
+                record.Limit = limit;
+                record.Status = status;
+                record.Kind = which;
+                record.Reason = reason;
+
+                const size_t length = std::min(callsign.length(), sizeof(record.Callsign) - 1);
+                ::memcpy(record.Callsign, callsign.c_str(), length);
+                ::memset(&(record.Callsign[length]), 0, sizeof(record.Callsign) - length);
+                ::memcpy(data, &record, sizeof(record));
+
+                const uint64_t ticket = _head.fetch_add(1, std::memory_order_relaxed);
+                Slot& slot(_slots[ticket & (_capacity - 1)]);
+
+                if (Claim(slot, ticket) == true) {
+                    std::atomic_thread_fence(std::memory_order_release);
+
+                    for (uint8_t index = 0; index < Words; index++) {
+                        slot.Data[index].store(data[index], std::memory_order_relaxed);
+                    }
+
+                    slot.Sequence.store((ticket << 1) + 2, std::memory_order_release);
+                }
+            }
+        }
+        // What is in there, oldest first. Returns how many records were lost: overwritten
+        // before, or while, they were read and the ones still being written.
+        uint64_t Read(std::vector<Record>& records) const
+        {
+            const uint64_t head = _head.load(std::memory_order_acquire);
+            const uint64_t from = (head > _capacity ? head - _capacity : 0);
+            uint64_t lost = from;
+
+            records.reserve(records.size() + static_cast<size_t>(head - from));
+
+            for (uint64_t ticket = from; ticket < head; ticket++) {
+                const Slot& slot(_slots[ticket & (_capacity - 1)]);
+                const uint64_t expected = (ticket << 1) + 2;
+                uint64_t data[Words];
+
+                if (slot.Sequence.load(std::memory_order_acquire) != expected) {
+                    lost++;
+                } else {
+                    for (uint8_t index = 0; index < Words; index++) {
+                        data[index] = slot.Data[index].load(std::memory_order_relaxed);
+                    }
+
+                    std::atomic_thread_fence(std::memory_order_acquire);
+
+                    if (slot.Sequence.load(std::memory_order_relaxed) != expected) {
+                        lost++;
+                    } else {
+                        records.emplace_back();
+                        ::memcpy(&(records.back()), data, sizeof(Record));
+                    }
+                }
+            }
+
+            return (lost);
+        }
+
+    private:
+        // A writer a whole lap behind must neither overwrite the newer record nor
+        // write along with it, so the slot goes to one writer at a time. Nobody
+        // waits for it: a record that is older than what the slot holds, or that
+        // finds another writer still at it, is dropped and Read counts it as lost.
+        static bool Claim(Slot& slot, const uint64_t ticket)
+        {
+            uint64_t current = slot.Sequence.load(std::memory_order_relaxed);
+            bool claimed = false;
+
+            // A failed exchange means another writer got the slot first, try again only if it is done and older.
+            while ((claimed == false) && ((current & 1) == 0) && ((current >> 1) <= ticket)) {
+                claimed = slot.Sequence.compare_exchange_weak(current, (ticket << 1) | 1, std::memory_order_relaxed);
+            }
+
+            return (claimed);
+        }
+
+    private:
+        std::unique_ptr<Slot[]> _slots;
+        uint32_t _capacity;
+        std::atomic<uint64_t> _head; //!< Ticket of the next record, the slot is the ticket modulo the capacity.
+    };
+
+} // namespace Plugin
+} // namespace WPEFramework
+
+#endif // __MONITOR_RECORDER_H
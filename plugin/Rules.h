@@ -0,0 +1,284 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __MONITOR_RULES_H
+#define __MONITOR_RULES_H
+
+#include <bitset>
+#include <cstdint>
+
+namespace WPEFramework {
+namespace Plugin {
+
+    // Decides when a series of failing samples is worth acting on. A violation is
+    // reported when at least Samples of the last Window samples failed and the
+    // current run of failing samples lasted at least Sustain MicroSeconds. The
+    // defaults (1 of 1, no sustain) act on the first failing sample.
+    class Violation {
+    public:
+        static constexpr uint8_t MaxWindow = 32;
+
+    public:
+        Violation()
+            : Violation(1, 1, 0)
+        {
+        }
+        Violation(const uint8_t samples, const uint8_t window, const uint64_t sustain /* MicroSeconds */)
+            : _window(window == 0 ? 1 : (window > MaxWindow ? MaxWindow : window))
+            , _samples(samples == 0 ? 1 : (samples > _window ? _window : samples))
+            , _sustain(sustain)
+            , _history(0)
+            , _since(Idle)
+        {
+        }
+        Violation(const Violation& copy) = default;
+        Violation& operator=(const Violation& rhs) = default;
+        ~Violation()
+        {
+        }
+
+    public:
+        inline uint8_t Samples() const
+        {
+            return (_samples);
+        }
+        inline uint8_t Window() const
+        {
+            return (_window);
+        }
+        inline uint64_t Sustain() const
+        {
+            return (_sustain);
+        }
+        // Registers a sample, true if the rule fires on it.
+        bool Set(const bool failed, const uint64_t now /* MicroSeconds */)
+        {
+            const uint32_t mask = (_window == MaxWindow ? static_cast<uint32_t>(~0) : ((1u << _window) - 1));
+
+            _history = ((_history << 1) | (failed ? 1 : 0)) & mask;
+
+            if (failed == false) {
+                _since = Idle;
+            } else if (_since == Idle) {
+                _since = now;
+            }
+
+            return ((failed == true) && (static_cast<uint8_t>(std::bitset<32>(_history).count()) >= _samples) && ((now - _since) >= _sustain));
+        }
+        inline void Reset()
+        {
+            _history = 0;
+            _since = Idle;
+        }
+
+    private:
+        static constexpr uint64_t Idle = static_cast<uint64_t>(~0);
+
+        uint8_t _window;
+        uint8_t _samples;
+        uint64_t _sustain;
+        uint32_t _history; //!< Bit per sample, LSB is the latest.
+        uint64_t _since; //!< Start of the current run of failing samples.
+    };
+
+    // Keeps a value that crossed a threshold above it until it dropped Clearance
+    // percent below that threshold, so a value hovering around the threshold does
+    // not flip the outcome on every sample.
+    class Hysteresis {
+    public:
+        Hysteresis()
+            : Hysteresis(0)
+        {
+        }
+        explicit Hysteresis(const uint8_t clearance /* percent */)
+            : _clearance(clearance > 100 ? 100 : clearance)
+            , _above(false)
+        {
+        }
+        Hysteresis(const Hysteresis& copy) = default;
+        Hysteresis& operator=(const Hysteresis& rhs) = default;
+        ~Hysteresis()
+        {
+        }
+
+    public:
+        inline uint8_t Clearance() const
+        {
+            return (_clearance);
+        }
+        bool Above(const uint64_t value, const uint64_t threshold)
+        {
+            if (_above == false) {
+                _above = (value > threshold);
+            } else {
+                _above = (value > (threshold - ((threshold * _clearance) / 100)));
+            }
+
+            return (_above);
+        }
+        inline void Reset()
+        {
+            _above = false;
+        }
+
+    private:
+        uint8_t _clearance;
+        bool _above;
+    };
+
+    // Picks the time till the next sample of a value watched against a limit.
+    // The interval doubles, up to Max, while the value is flat and far below the
+    // limit, halves on a swing, and falls back to Min as soon as the value is
+    // close to the limit or would reach it within two more samples at its
+    // current pace. Intervals are Min times a power of two, so they stay a
+    // multiple of any tick Min is a multiple of.
+    class Cadence {
+    public:
+        static constexpr uint8_t Near = 80; //!< Percent of the limit from where sampling is as fast as allowed.
+        static constexpr uint8_t Far = 50; //!< Percent of the limit below which sampling may slow down.
+        static constexpr uint8_t Swing = 5; //!< Percent change between two samples that speeds sampling up.
+        static constexpr uint8_t Flat = 1; //!< Percent change between two samples that counts as flat.
+
+    public:
+        Cadence() = delete;
+
+        Cadence(const uint32_t min, const uint32_t max, const uint32_t start)
+            : _min(min == 0 ? 1 : min)
+            , _max(_min)
+            , _interval(_min)
+            , _last(0)
+            , _primed(false)
+        {
+            while (_max <= (max / 2)) {
+                _max *= 2;
+            }
+            while ((_interval < _max) && (_interval <= (start / 2))) {
+                _interval *= 2;
+            }
+        }
+        Cadence(const Cadence& copy) = default;
+        Cadence& operator=(const Cadence& rhs) = default;
+        ~Cadence()
+        {
+        }
+
+    public:
+        inline uint32_t Min() const
+        {
+            return (_min);
+        }
+        inline uint32_t Max() const
+        {
+            return (_max);
+        }
+        inline uint32_t Interval() const
+        {
+            return (_interval);
+        }
+        // Registers a sample, a limit of 0 means there is none. Returns the interval till the next sample.
+        uint32_t Set(const uint64_t value, const uint64_t limit)
+        {
+            if (_primed == false) {
+                _primed = true;
+            } else {
+                const uint64_t delta = (value > _last ? value - _last : _last - value);
+                // Only a rise is projected towards the limit, a drop moves away from it.
+                const uint64_t increase = (value > _last ? delta : 0);
+
+                if ((limit != 0) && (((value * 100) >= (limit * Near)) || ((value + (increase * 2)) >= limit))) {
+                    _interval = _min;
+                } else if ((delta * 100) > (_last * Swing)) {
+                    _interval = (_interval > _min ? _interval / 2 : _min);
+                } else if (((limit == 0) || ((value * 100) < (limit * Far))) && ((delta * 100) <= (_last * Flat))) {
+                    _interval = (_interval < _max ? _interval * 2 : _max);
+                }
+            }
+
+            _last = value;
+
+            return (_interval);
+        }
+        inline void Reset()
+        {
+            _primed = false;
+        }
+
+    private:
+        uint32_t _min;
+        uint32_t _max;
+        uint32_t _interval;
+        uint64_t _last;
+        bool _primed;
+    };
+
+    // Decides whether a plugin that went down may be restarted: at most limit
+    // restarts within window seconds, where the window opens with the first
+    // restart after the previous one closed. A limit of 0 allows any number of
+    // restarts, a window of 0 never closes. Once the limit is hit the count
+    // starts over, so a plugin activated by hand again gets a fresh set.
+    class Restarts {
+    public:
+        Restarts()
+            : _end(0)
+            , _count(0)
+        {
+        }
+        Restarts(const Restarts& copy) = default;
+        Restarts& operator=(const Restarts& rhs) = default;
+        ~Restarts()
+        {
+        }
+
+    public:
+        inline uint32_t Count() const
+        {
+            return (_count);
+        }
+        // Registers a restart, true if it is allowed.
+        bool Register(const uint8_t limit, const uint16_t window /* seconds */, const uint64_t now /* MicroSeconds */)
+        {
+            if ((_count != 0) && ((window == 0) || (now < _end))) {
+                _count++;
+            } else {
+                _end = now + (static_cast<uint64_t>(window) * 1000 * 1000);
+                _count = 1;
+            }
+
+            const bool result = ((limit == 0) || (_count <= limit));
+
+            if (result == false) {
+                _count = 0;
+            }
+
+            return (result);
+        }
+        inline void Reset()
+        {
+            _count = 0;
+        }
+
+    private:
+        uint64_t _end; //!< MicroSeconds, end of the current window.
+        uint32_t _count; //!< Restarts within the current window, this one included.
+    };
+
+} // namespace Plugin
+} // namespace WPEFramework
+
+#endif // __MONITOR_RULES_H
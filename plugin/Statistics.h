@@ -0,0 +1,356 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __MONITOR_STATISTICS_H
+#define __MONITOR_STATISTICS_H
+
+#include <cstdint>
+#include <cstring>
+
+namespace WPEFramework {
+namespace Plugin {
+
+    // Fixed size log-linear histogram. Every power of two is split in SubBuckets
+    // linear buckets, so a reported quantile is off by at most 1/SubBuckets of
+    // its value, whatever the magnitude. Recording is a bit scan, a shift and an
+    // increment; the memory footprint is constant.
+    class Histogram {
+    public:
+        static constexpr uint8_t SubBucketBits = 3;
+        static constexpr uint32_t SubBuckets = (1 << SubBucketBits);
+        static constexpr uint32_t Buckets = ((64 - SubBucketBits + 1) * SubBuckets);
+
+    public:
+        Histogram()
+            : _count(0)
+        {
+            ::memset(_buckets, 0, sizeof(_buckets));
+        }
+        Histogram(const Histogram& copy)
+            : _count(copy._count)
+        {
+            ::memcpy(_buckets, copy._buckets, sizeof(_buckets));
+        }
+        ~Histogram()
+        {
+        }
+
+        Histogram& operator=(const Histogram& rhs)
+        {
+            _count = rhs._count;
+            ::memcpy(_buckets, rhs._buckets, sizeof(_buckets));
+
+            return (*this);
+        }
+
+    public:
+        inline void Set(const uint64_t value)
+        {
+            uint32_t& bucket(_buckets[Index(value)]);
+
+            // Saturate rather than wrap, a wrapped bucket would skew every quantile.
+            if (bucket != static_cast<uint32_t>(~0)) {
+                bucket++;
+                _count++;
+            }
+        }
+        inline void Reset()
+        {
+            _count = 0;
+            ::memset(_buckets, 0, sizeof(_buckets));
+        }
+        inline uint32_t Measurements() const
+        {
+            return (_count);
+        }
+        // Quantile in the range [0.0, 1.0], e.g. 0.95 for the 95th percentile.
+        uint64_t Quantile(const double quantile) const
+        {
+            uint64_t result = 0;
+
+            if (_count != 0) {
+                uint64_t rank = static_cast<uint64_t>((quantile * _count) + 0.5);
+                uint64_t seen = 0;
+                uint32_t index = 0;
+
+                if (rank == 0) {
+                    rank = 1;
+                } else if (rank > _count) {
+                    rank = _count;
+                }
+
+                while ((index < (Buckets - 1)) && ((seen + _buckets[index]) < rank)) {
+                    seen += _buckets[index];
+                    index++;
+                }
+
+                result = Value(index);
+            }
+
+            return (result);
+        }
+
+    private:
+        static inline uint32_t Index(const uint64_t value)
+        {
+            uint32_t result = static_cast<uint32_t>(value);
+
+            if (value >= SubBuckets) {
+                const uint32_t shift = Highest(value) - SubBucketBits;
+                result = ((shift + 1) * SubBuckets) + static_cast<uint32_t>((value >> shift) & (SubBuckets - 1));
+            }
+
+            return (result);
+        }
+        // Position of the highest bit set, value is not 0.
+        static inline uint32_t Highest(uint64_t value)
+        {
+#if defined(__GNUC__)
+            return (63 - __builtin_clzll(value));
+#else
+            uint32_t result = 0;
+
+            while ((value >>= 1) != 0) {
+                result++;
+            }
+
+            return (result);
+#endif
+        }
+        // Midpoint of the bucket, the lower buckets are exact.
+        static inline uint64_t Value(const uint32_t index)
+        {
+            uint64_t result = index;
+
+            if (index >= SubBuckets) {
+                const uint32_t shift = (index / SubBuckets) - 1;
+                const uint64_t lower = static_cast<uint64_t>(SubBuckets + (index % SubBuckets)) << shift;
+                result = lower + ((static_cast<uint64_t>(1) << shift) >> 1);
+            }
+
+            return (result);
+        }
+
+    private:
+        uint32_t _count;
+        uint32_t _buckets[Buckets];
+    };
+
+    // Distribution of a duration, e.g. the time spent in a call, in MicroSeconds.
+    class Latency {
+    public:
+        Latency()
+            : _distribution()
+            , _total(0)
+            , _max(0)
+        {
+        }
+        Latency(const Latency& copy) = default;
+        Latency& operator=(const Latency& rhs) = default;
+        ~Latency()
+        {
+        }
+
+    public:
+        inline void Set(const uint64_t duration)
+        {
+            _distribution.Set(duration);
+            _total += duration;
+            if (duration > _max) {
+                _max = duration;
+            }
+        }
+        inline void Reset()
+        {
+            _distribution.Reset();
+            _total = 0;
+            _max = 0;
+        }
+        inline uint32_t Measurements() const
+        {
+            return (_distribution.Measurements());
+        }
+        inline uint64_t Total() const
+        {
+            return (_total);
+        }
+        inline uint64_t Average() const
+        {
+            return (_distribution.Measurements() != 0 ? (_total / _distribution.Measurements()) : 0);
+        }
+        inline uint64_t Max() const
+        {
+            return (_max);
+        }
+        inline uint64_t Quantile(const double quantile) const
+        {
+            return (_distribution.Quantile(quantile));
+        }
+
+    private:
+        Histogram _distribution;
+        uint64_t _total;
+        uint64_t _max;
+    };
+
+    // Rolling aggregate over (roughly) the last span seconds. The span is cut in
+    // Slots buckets, a bucket is recycled as soon as the clock moves past it, so
+    // adding a sample is O(1) and expired samples never need to be walked. The
+    // reported range lies between (Slots - 1)/Slots of the span and the span.
+    class Window {
+    public:
+        static constexpr uint8_t Slots = 12;
+
+        struct Aggregate {
+            uint64_t Min;
+            uint64_t Max;
+            uint64_t Average;
+            uint32_t Count;
+        };
+
+    public:
+        Window() = delete;
+
+        explicit Window(const uint32_t span /* seconds */)
+            : _slotDuration((static_cast<uint64_t>(span) * 1000 * 1000) / Slots) // MicroSeconds
+        {
+            ::memset(_slots, 0, sizeof(_slots));
+        }
+        Window(const Window& copy)
+            : _slotDuration(copy._slotDuration)
+        {
+            ::memcpy(_slots, copy._slots, sizeof(_slots));
+        }
+        ~Window()
+        {
+        }
+
+        Window& operator=(const Window& rhs)
+        {
+            _slotDuration = rhs._slotDuration;
+            ::memcpy(_slots, rhs._slots, sizeof(_slots));
+
+            return (*this);
+        }
+
+    public:
+        inline void Set(const uint64_t value, const uint64_t now /* MicroSeconds */)
+        {
+            const uint64_t slot = now / _slotDuration;
+            Entry& entry(_slots[slot % Slots]);
+
+            if ((entry.Slot != slot) || (entry.Count == 0)) {
+                entry.Slot = slot;
+                entry.Min = value;
+                entry.Max = value;
+                entry.Sum = 0;
+                entry.Count = 0;
+            } else if (value < entry.Min) {
+                entry.Min = value;
+            } else if (value > entry.Max) {
+                entry.Max = value;
+            }
+
+            entry.Sum += value;
+            entry.Count++;
+        }
+        Aggregate Get(const uint64_t now /* MicroSeconds */) const
+        {
+            const uint64_t current = now / _slotDuration;
+            Aggregate result = { static_cast<uint64_t>(~0), 0, 0, 0 };
+            uint64_t sum = 0;
+
+            for (uint8_t index = 0; index < Slots; index++) {
+                const Entry& entry(_slots[index]);
+
+                if ((entry.Count != 0) && (entry.Slot <= current) && ((entry.Slot + Slots) > current)) {
+                    if (entry.Min < result.Min) {
+                        result.Min = entry.Min;
+                    }
+                    if (entry.Max > result.Max) {
+                        result.Max = entry.Max;
+                    }
+                    sum += entry.Sum;
+                    result.Count += entry.Count;
+                }
+            }
+
+            if (result.Count != 0) {
+                result.Average = sum / result.Count;
+            } else {
+                result.Min = 0;
+            }
+
+            return (result);
+        }
+
+    private:
+        struct Entry {
+            uint64_t Slot;
+            uint64_t Min;
+            uint64_t Max;
+            uint64_t Sum;
+            uint32_t Count;
+        };
+
+        uint64_t _slotDuration;
+        Entry _slots[Slots];
+    };
+
+    // The rolling horizons reported next to the lifetime measurements.
+    class Windows {
+    public:
+        enum horizon : uint8_t {
+            MINUTE = 0,
+            FIVE_MINUTES = 1,
+            HOUR = 2,
+            HORIZONS = 3
+        };
+
+    public:
+        Windows()
+            : _windows{ Window(60), Window(5 * 60), Window(60 * 60) }
+        {
+        }
+        Windows(const Windows& copy) = default;
+        Windows& operator=(const Windows& rhs) = default;
+        ~Windows()
+        {
+        }
+
+    public:
+        inline void Set(const uint64_t value, const uint64_t now /* MicroSeconds */)
+        {
+            _windows[MINUTE].Set(value, now);
+            _windows[FIVE_MINUTES].Set(value, now);
+            _windows[HOUR].Set(value, now);
+        }
+        inline Window::Aggregate Get(const horizon which, const uint64_t now /* MicroSeconds */) const
+        {
+            return (_windows[which].Get(now));
+        }
+
+    private:
+        Window _windows[HORIZONS];
+    };
+
+} // namespace Plugin
+} // namespace WPEFramework
+
+#endif // __MONITOR_STATISTICS_H
@@ -0,0 +1,211 @@
+/*
+ * If not stated otherwise in this file or this component's LICENSE file the
+ * following copyright and licenses apply:
+ *
+ * Copyright 2020 RDK Management
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __MONITOR_TELEMETRY_H
+#define __MONITOR_TELEMETRY_H
+
+#include "Module.h"
+#include <map>
+#include <telemetry_busmessage_sender.h>
+
+namespace WPEFramework {
+namespace Plugin {
+
+    // Collects T2 markers and hands them to the sender in batches, so a burst of
+    // actions costs one bus message per marker instead of one per action.
+    //  - Event: markers carrying a string, identical strings are folded into
+    //           "value:count" and all of them are sent comma separated.
+    //  - Value: markers carrying a string, only the last one is sent.
+    // Markers that have to be seen right away skip the batch (Immediate).
+    class Telemetry {
+    public:
+        struct ISender {
+            virtual ~ISender() = default;
+
+            virtual void Send(const string& marker, const uint32_t value) = 0;
+            virtual void Send(const string& marker, const string& value) = 0;
+        };
+
+        // The real thing, the tests hand their own sender to the constructor.
+        class BusSender : public ISender {
+        public:
+            BusSender(const BusSender&) = delete;
+            BusSender& operator=(const BusSender&) = delete;
+
+            BusSender() = default;
+            ~BusSender() override = default;
+
+        public:
+            void Send(const string& marker, const uint32_t value) override
+            {
+                t2_event_d(marker.c_str(), static_cast<int>(value));
+            }
+            void Send(const string& marker, const string& value) override
+            {
+                t2_event_s(marker.c_str(), value.c_str());
+            }
+        };
+
+    public:
+        Telemetry() = delete;
+        Telemetry(const Telemetry&) = delete;
+        Telemetry& operator=(const Telemetry&) = delete;
+
+PUSH_WARNING(DISABLE_WARNING_THIS_IN_MEMBER_INITIALIZER_LIST)
+        Telemetry(ISender& sender)
+            : _adminLock()
+            , _sender(&sender)
+            , _interval(0)
+            , _scheduled(false)
+            , _events()
+            , _values()
+            , _job(*this)
+        {
+        }
+POP_WARNING()
+        ~Telemetry()
+        {
+            Close();
+        }
+
+    public:
+        // Interval in seconds between two flushes, 0 sends every marker right away.
+        inline void Open(const uint32_t interval)
+        {
+            _adminLock.Lock();
+            _interval = interval;
+            _adminLock.Unlock();
+        }
+        inline void Close()
+        {
+            _job.Revoke();
+            Flush();
+        }
+        void Event(const string& marker, const string& value)
+        {
+            if (marker.empty() == false) {
+                _adminLock.Lock();
+                _events[marker][value]++;
+                const uint32_t due = Due();
+                _adminLock.Unlock();
+
+                Schedule(due);
+            }
+        }
+        void Value(const string& marker, const string& value)
+        {
+            if (marker.empty() == false) {
+                _adminLock.Lock();
+                _values[marker] = value;
+                const uint32_t due = Due();
+                _adminLock.Unlock();
+
+                Schedule(due);
+            }
+        }
+        // Sent right away, next to whatever is batched.
+        void Immediate(const string& marker, const uint32_t value = 1)
+        {
+            if (marker.empty() == false) {
+                _adminLock.Lock();
+                ISender* sender = _sender;
+                _adminLock.Unlock();
+
+                sender->Send(marker, value);
+            }
+        }
+        void Flush()
+        {
+            Events events;
+            Values values;
+
+            _adminLock.Lock();
+            events.swap(_events);
+            values.swap(_values);
+            _scheduled = false;
+            ISender* sender = _sender;
+            _adminLock.Unlock();
+
+            for (const auto& entry : events) {
+                string text;
+                for (const auto& value : entry.second) {
+                    if (text.empty() == false) {
+                        text += ',';
+                    }
+                    text += value.first;
+                    text += ':';
+                    text += std::to_string(value.second);
+                }
+                sender->Send(entry.first, text);
+            }
+            for (const auto& entry : values) {
+                sender->Send(entry.first, entry.second);
+            }
+        }
+
+    private:
+        friend Core::ThreadPool::JobType<Telemetry&>;
+
+        // Called with the lock taken: seconds until the markers are to be flushed, Never if a flush is on its way.
+        inline uint32_t Due()
+        {
+            uint32_t result = Never;
+
+            if (_interval == 0) {
+                result = 0;
+            } else if (_scheduled == false) {
+                _scheduled = true;
+                result = _interval;
+            }
+
+            return (result);
+        }
+        // Without the lock, a flush that is running needs it.
+        inline void Schedule(const uint32_t due)
+        {
+            if (due == 0) {
+                _job.Submit();
+            } else if (due != Never) {
+                _job.Reschedule(Core::Time::Now().Add(due * 1000));
+            }
+        }
+        void Dispatch()
+        {
+            Flush();
+        }
+
+    private:
+        static constexpr uint32_t Never = static_cast<uint32_t>(~0);
+
+        using Events = std::map<string, std::map<string, uint32_t>>;
+        using Values = std::map<string, string>;
+
+        Core::CriticalSection _adminLock;
+        ISender* _sender;
+        uint32_t _interval;
+        bool _scheduled;
+        Events _events;
+        Values _values;
+        Core::WorkerPool::JobType<Telemetry&> _job;
+    };
+
+} // namespace Plugin
+} // namespace WPEFramework
+
+#endif // __MONITOR_TELEMETRY_H